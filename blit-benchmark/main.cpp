@@ -4,8 +4,14 @@
 
 #include <cassert>
 
+#include "../draw2d/atlas.hpp"
 #include "../draw2d/image.hpp"
+#include "../draw2d/mipmap.hpp"
+#include "../draw2d/sprite.hpp"
 #include "../draw2d/surface.hpp"
+#include "../draw2d/transform_blit.hpp"
+
+#include "../vmlib/mat22.hpp"
 
 
 // Image of phone - phone.png found at:
@@ -54,7 +60,7 @@ namespace
 		Surface surface( width, height );
 		surface.clear();
 
-		auto source = load_image( "assets/earth.png" );
+		auto source = load_image_cached( "assets/earth.png" );
 		assert( source );
 
 		for( auto _ : aState )
@@ -86,7 +92,7 @@ namespace
 		Surface surface( width, height );
 		surface.clear();
 
-		auto source = load_image( "assets/earth.png" );
+		auto source = load_image_cached( "assets/earth.png" );
 		assert( source );
 
 		for( auto _ : aState )
@@ -118,7 +124,7 @@ namespace
 		Surface surface( width, height );
 		surface.clear();
 
-		auto source = load_image( "assets/phone.png" );
+		auto source = load_image_cached( "assets/phone.png" );
 		assert( source );
 
 		for( auto _ : aState )
@@ -150,7 +156,7 @@ namespace
 		Surface surface( width, height );
 		surface.clear();
 
-		auto source = load_image( "assets/phone.png" );
+		auto source = load_image_cached( "assets/phone.png" );
 		assert( source );
 
 		for( auto _ : aState )
@@ -182,7 +188,7 @@ namespace
 		Surface surface( width, height );
 		surface.clear();
 
-		auto source = load_image( "assets/moon.png" );
+		auto source = load_image_cached( "assets/moon.png" );
 		assert( source );
 
 		for( auto _ : aState )
@@ -214,7 +220,7 @@ namespace
 		Surface surface( width, height );
 		surface.clear();
 
-		auto source = load_image( "assets/moon.png" );
+		auto source = load_image_cached( "assets/moon.png" );
 		assert( source );
 
 		for( auto _ : aState )
@@ -236,6 +242,185 @@ namespace
 
 		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
 	}
+
+	// pre-swizzled sprite blit on the earth image
+	void sprite_blit_earth_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		auto const source = make_sprite( *load_image_cached( "assets/earth.png" ) );
+
+		for( auto _ : aState )
+		{
+			blit_masked( surface, source, {0.f, 0.f} );
+
+			// ClobberMemory() ensures that the compiler won't optimize away
+			// our blit operation. (Unlikely, but technically poossible.)
+			benchmark::ClobberMemory(); 
+		}
+
+		// See default_blit_earth_() for a discussion of the byte count.
+		auto const maxBlitX = std::min( width, source.get_width() );
+		auto const maxBlitY = std::min( height, source.get_height() );
+
+		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
+	}
+
+	// pre-swizzled sprite blit on small image - phone.png
+	void sprite_blit_small_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		auto const source = make_sprite( *load_image_cached( "assets/phone.png" ) );
+
+		for( auto _ : aState )
+		{
+			blit_masked( surface, source, {0.f, 0.f} );
+
+			// ClobberMemory() ensures that the compiler won't optimize away
+			// our blit operation. (Unlikely, but technically poossible.)
+			benchmark::ClobberMemory(); 
+		}
+
+		// See default_blit_earth_() for a discussion of the byte count.
+		auto const maxBlitX = std::min( width, source.get_width() );
+		auto const maxBlitY = std::min( height, source.get_height() );
+
+		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
+	}
+
+	// pre-swizzled sprite blit on large image - moon.png
+	void sprite_blit_large_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		auto const source = make_sprite( *load_image_cached( "assets/moon.png" ) );
+
+		for( auto _ : aState )
+		{
+			blit_masked( surface, source, {0.f, 0.f} );
+
+			// ClobberMemory() ensures that the compiler won't optimize away
+			// our blit operation. (Unlikely, but technically poossible.)
+			benchmark::ClobberMemory(); 
+		}
+
+		// See default_blit_earth_() for a discussion of the byte count.
+		auto const maxBlitX = std::min( width, source.get_width() );
+		auto const maxBlitY = std::min( height, source.get_height() );
+
+		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
+	}
+
+	// blit of the earth from an atlas holding all three images
+	void atlas_blit_earth_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+
+		Surface surface( width, height );
+		surface.clear();
+
+		auto const earth = load_image_cached( "assets/earth.png" );
+		auto const phone = load_image_cached( "assets/phone.png" );
+		auto const moon = load_image_cached( "assets/moon.png" );
+
+		ImageRGBA const* const images[] = { earth.get(), phone.get(), moon.get() };
+		auto const atlas = make_sprite_atlas( 3, images );
+
+		for( auto _ : aState )
+		{
+			blit_masked( surface, atlas, 0, {0.f, 0.f} );
+
+			// ClobberMemory() ensures that the compiler won't optimize away
+			// our blit operation. (Unlikely, but technically poossible.)
+			benchmark::ClobberMemory(); 
+		}
+
+		// See default_blit_earth_() for a discussion of the byte count. This
+		// uses the untrimmed size, to stay comparable with the other blits.
+		auto const maxBlitX = std::min( width, earth->get_width() );
+		auto const maxBlitY = std::min( height, earth->get_height() );
+
+		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
+	}
+
+	// downscaled blit of the earth using its mip chain. The scale is given
+	// in percent, as the third argument.
+	void scaled_blit_earth_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const scale = float(aState.range(2)) / 100.f;
+
+		Surface surface( width, height );
+		surface.clear();
+
+		auto const source = make_sprite_mips( *load_image_cached( "assets/earth.png" ) );
+
+		for( auto _ : aState )
+		{
+			blit_masked_scaled( surface, source, {0.f, 0.f}, scale );
+
+			// ClobberMemory() ensures that the compiler won't optimize away
+			// our blit operation. (Unlikely, but technically poossible.)
+			benchmark::ClobberMemory(); 
+		}
+
+		// Count the destination rectangle; each destination pixel is read
+		// once from the selected mip level and written once.
+		auto const& base = source.get_level( 0 );
+		auto const maxBlitX = std::min( width, std::uint32_t(base.get_width() * scale + 0.5f) );
+		auto const maxBlitY = std::min( height, std::uint32_t(base.get_height() * scale + 0.5f) );
+
+		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
+	}
+
+	// rotated blit of the earth (pre-swizzled sprite). The rotation is given
+	// in degrees, as the third argument.
+	void rotated_blit_earth_( benchmark::State& aState )
+	{
+		auto const width = std::uint32_t(aState.range(0));
+		auto const height = std::uint32_t(aState.range(1));
+		auto const angle = float(aState.range(2)) * 3.14159265f / 180.f;
+		auto const mode = 0 != aState.range(3) ? ESampleMode::bilinear : ESampleMode::nearest;
+
+		Surface surface( width, height );
+		surface.clear();
+
+		auto const source = make_sprite( *load_image_cached( "assets/earth.png" ) );
+
+		auto const rot = make_rotation_2d( angle );
+		auto const center = Vec2f{ width*0.5f, height*0.5f };
+
+		for( auto _ : aState )
+		{
+			blit_transformed( surface, source, rot, center, mode );
+
+			// ClobberMemory() ensures that the compiler won't optimize away
+			// our blit operation. (Unlikely, but technically poossible.)
+			benchmark::ClobberMemory(); 
+		}
+
+		// Approximate; counts the area of the (unrotated) image that fits on
+		// the surface.
+		auto const maxBlitX = std::min( width, source.get_width() );
+		auto const maxBlitY = std::min( height, source.get_height() );
+
+		aState.SetBytesProcessed( 2*maxBlitX*maxBlitY*4 * aState.iterations() );
+	}
 }
 
 // Default blitting on the earth
@@ -286,4 +471,52 @@ BENCHMARK( no_alpha_mask_blit_large_ )
 	->Args( { 7680, 4320 } ) // 8k framebuffer
 ;
 
+// Pre-swizzled sprite blitting on the earth
+BENCHMARK( sprite_blit_earth_ )
+	->Args( { 320, 240 } ) // Small framebuffer
+	->Args( { 1280, 720 } ) // Default framebuffer
+	->Args( { 1920, 1080 } ) // Full HD framebuffer
+	->Args( { 7680, 4320 } ) // 8k framebuffer
+;
+
+// Pre-swizzled sprite blitting on small image
+BENCHMARK( sprite_blit_small_ )
+	->Args( { 320, 240 } ) // Small framebuffer
+	->Args( { 1280, 720 } ) // Default framebuffer
+	->Args( { 1920, 1080 } ) // Full HD framebuffer
+	->Args( { 7680, 4320 } ) // 8k framebuffer
+;
+
+// Pre-swizzled sprite blitting on large image
+BENCHMARK( sprite_blit_large_ )
+	->Args( { 320, 240 } ) // Small framebuffer
+	->Args( { 1280, 720 } ) // Default framebuffer
+	->Args( { 1920, 1080 } ) // Full HD framebuffer
+	->Args( { 7680, 4320 } ) // 8k framebuffer
+;
+
+// Atlas blitting on the earth
+BENCHMARK( atlas_blit_earth_ )
+	->Args( { 320, 240 } ) // Small framebuffer
+	->Args( { 1280, 720 } ) // Default framebuffer
+	->Args( { 1920, 1080 } ) // Full HD framebuffer
+	->Args( { 7680, 4320 } ) // 8k framebuffer
+;
+
+// Scaled blitting on the earth
+BENCHMARK( scaled_blit_earth_ )
+	->Args( { 1920, 1080, 100 } ) // Full HD framebuffer, full size
+	->Args( { 1920, 1080, 50 } ) // Full HD framebuffer, half size
+	->Args( { 1920, 1080, 10 } ) // Full HD framebuffer, "minimap" size
+;
+
+// Rotated blitting on the earth
+BENCHMARK( rotated_blit_earth_ )
+	->Args( { 1920, 1080, 0, 0 } ) // Full HD framebuffer, no rotation
+	->Args( { 1920, 1080, 30, 0 } ) // Full HD framebuffer, 30 degrees
+	->Args( { 7680, 4320, 30, 0 } ) // 8k framebuffer, 30 degrees
+	->Args( { 1920, 1080, 30, 1 } ) // Full HD framebuffer, 30 degrees, bilinear
+	->Args( { 7680, 4320, 30, 1 } ) // 8k framebuffer, 30 degrees, bilinear
+;
+
 BENCHMARK_MAIN();
@@ -0,0 +1,98 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "helpers.hpp"
+
+#include "../draw2d/atlas.hpp"
+#include "../draw2d/image.hpp"
+#include "../draw2d/surface.hpp"
+
+namespace
+{
+	// Noise image with a fully transparent border of the given widths. Two
+	// opaque corners pin the trimmed rectangle to the inside of the border.
+	std::unique_ptr<TestImage> make_bordered_( ImageRGBA::Index aWidth, ImageRGBA::Index aHeight, ImageRGBA::Index aLeft, ImageRGBA::Index aRight, ImageRGBA::Index aBottom, ImageRGBA::Index aTop, unsigned aSeed )
+	{
+		auto ret = make_noise_image( aWidth, aHeight, aSeed );
+
+		for( ImageRGBA::Index y = 0; y < aHeight; ++y )
+		{
+			for( ImageRGBA::Index x = 0; x < aWidth; ++x )
+			{
+				if( x < aLeft || x >= aWidth-aRight || y < aBottom || y >= aHeight-aTop )
+					ret->set_pixel( x, y, { 255, 0, 255, 0 } );
+			}
+		}
+
+		if( aLeft+aRight < aWidth && aBottom+aTop < aHeight )
+		{
+			ret->set_pixel( aLeft, aBottom, { 1, 2, 3, 255 } );
+			ret->set_pixel( aWidth-aRight-1, aHeight-aTop-1, { 4, 5, 6, 255 } );
+		}
+
+		return ret;
+	}
+}
+
+TEST_CASE( "Atlas blits", "[atlas]" )
+{
+	std::vector<std::unique_ptr<TestImage>> images;
+	images.emplace_back( make_bordered_( 16, 12, 0, 0, 0, 0, 1 ) );
+	images.emplace_back( make_bordered_( 20, 9, 3, 1, 2, 4, 2 ) );
+	images.emplace_back( make_bordered_( 7, 25, 2, 2, 5, 0, 3 ) );
+	images.emplace_back( make_bordered_( 6, 6, 6, 0, 0, 0, 4 ) ); // fully transparent
+	images.emplace_back( make_bordered_( 31, 14, 0, 9, 0, 1, 5 ) );
+
+	std::vector<ImageRGBA const*> pointers;
+	for( auto const& image : images )
+		pointers.emplace_back( image.get() );
+
+	auto const atlas = make_sprite_atlas( pointers.size(), pointers.data() );
+	REQUIRE( images.size() == atlas.size() );
+
+	Vec2f const positions[] = {
+		{ 0.f, 0.f },
+		{ 12.f, 9.f },
+		{ -4.f, 5.f },
+		{ -2.7f, -3.2f },
+		{ 25.f, 20.f },
+		{ 3.f, -20.f },
+		{ 50.f, 5.f }
+	};
+
+	Surface expected( 36, 28 ), actual( 36, 28 );
+
+	SECTION( "same as blit_masked" )
+	{
+		for( std::size_t i = 0; i < images.size(); ++i )
+		{
+			for( auto const pos : positions )
+			{
+				fill_pattern( expected );
+				fill_pattern( actual );
+
+				blit_masked( expected, *images[i], pos );
+				blit_masked( actual, atlas, i, pos );
+
+				INFO( "sprite " << i << " at " << pos.x << ", " << pos.y );
+				REQUIRE( 0 == count_differences( expected, actual ) );
+			}
+		}
+	}
+
+	SECTION( "trimmed" )
+	{
+		auto const& entry = atlas.get_entry( 1 );
+		REQUIRE( 3 == entry.offsetX );
+		REQUIRE( 2 == entry.offsetY );
+		REQUIRE( 20 == entry.sourceWidth );
+		REQUIRE( 9 == entry.sourceHeight );
+
+		REQUIRE( 16 == entry.rect.width );
+		REQUIRE( 3 == entry.rect.height );
+
+		REQUIRE( 0 == atlas.get_entry( 3 ).rect.width * atlas.get_entry( 3 ).rect.height );
+	}
+}
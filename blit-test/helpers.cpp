@@ -0,0 +1,115 @@
+#include "helpers.hpp"
+
+#include <random>
+
+#include <cassert>
+
+#include "../draw2d/surface.hpp"
+
+
+TestImage::TestImage( Index aWidth, Index aHeight )
+{
+	mWidth = aWidth;
+	mHeight = aHeight;
+	mData = new std::uint8_t[std::size_t(aWidth) * aHeight * 4]();
+}
+
+TestImage::~TestImage()
+{
+	delete [] mData;
+}
+
+void TestImage::set_pixel( Index aX, Index aY, ColorU8_sRGB_Alpha aColor )
+{
+	assert( aX < mWidth && aY < mHeight );
+
+	auto const idx = get_linear_index( aX, aY );
+	mData[idx+0] = aColor.r;
+	mData[idx+1] = aColor.g;
+	mData[idx+2] = aColor.b;
+	mData[idx+3] = aColor.a;
+}
+
+
+std::unique_ptr<TestImage> make_noise_image( ImageRGBA::Index aWidth, ImageRGBA::Index aHeight, unsigned aSeed )
+{
+	auto ret = std::make_unique<TestImage>( aWidth, aHeight );
+
+	std::minstd_rand rng( aSeed );
+	std::uniform_int_distribution<int> byte( 0, 255 );
+	std::uniform_int_distribution<int> alpha( 124, 131 );
+
+	for( ImageRGBA::Index y = 0; y < aHeight; ++y )
+	{
+		for( ImageRGBA::Index x = 0; x < aWidth; ++x )
+		{
+			ColorU8_sRGB_Alpha color;
+			color.r = std::uint8_t(byte( rng ));
+			color.g = std::uint8_t(byte( rng ));
+			color.b = std::uint8_t(byte( rng ));
+
+			// Mostly fully opaque or fully transparent, with some pixels
+			// close to the threshold.
+			switch( byte( rng ) % 3 )
+			{
+				case 0: color.a = 0; break;
+				case 1: color.a = 255; break;
+				default: color.a = std::uint8_t(alpha( rng )); break;
+			}
+
+			ret->set_pixel( x, y, color );
+		}
+	}
+
+	return ret;
+}
+
+std::unique_ptr<TestImage> crop_image( ImageRGBA const& aImage, ImageRGBA::Index aX, ImageRGBA::Index aY, ImageRGBA::Index aWidth, ImageRGBA::Index aHeight )
+{
+	auto ret = std::make_unique<TestImage>( aWidth, aHeight );
+
+	for( ImageRGBA::Index y = 0; y < aHeight; ++y )
+	{
+		for( ImageRGBA::Index x = 0; x < aWidth; ++x )
+			ret->set_pixel( x, y, aImage.get_pixel( aX + x, aY + y ) );
+	}
+
+	return ret;
+}
+
+void fill_pattern( Surface& aSurface )
+{
+	for( Surface::Index y = 0; y < aSurface.get_height(); ++y )
+	{
+		for( Surface::Index x = 0; x < aSurface.get_width(); ++x )
+			aSurface.set_pixel_srgb( x, y, { std::uint8_t(x*7), std::uint8_t(y*13), 77 } );
+	}
+}
+
+std::size_t count_differences( Surface const& aA, Surface const& aB )
+{
+	assert( aA.get_width() == aB.get_width() && aA.get_height() == aB.get_height() );
+
+	std::size_t count = 0;
+	for( Surface::Index y = 0; y < aA.get_height(); ++y )
+	{
+		for( Surface::Index x = 0; x < aA.get_width(); ++x )
+		{
+			auto const a = get_pixel( aA, x, y );
+			auto const b = get_pixel( aB, x, y );
+
+			if( a.r != b.r || a.g != b.g || a.b != b.b )
+				++count;
+		}
+	}
+
+	return count;
+}
+
+ColorU8_sRGB get_pixel( Surface const& aSurface, std::uint32_t aX, std::uint32_t aY )
+{
+	assert( aX < aSurface.get_width() && aY < aSurface.get_height() );
+
+	auto const ptr = aSurface.get_surface_ptr() + aSurface.get_linear_index( aX, aY );
+	return { ptr[0], ptr[1], ptr[2] };
+}
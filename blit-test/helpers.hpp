@@ -0,0 +1,41 @@
+#ifndef HELPERS_HPP_5E0B8C27_41D3_4A96_9F2E_B7C63D18A4F0
+#define HELPERS_HPP_5E0B8C27_41D3_4A96_9F2E_B7C63D18A4F0
+
+#include <memory>
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "../draw2d/forward.hpp"
+#include "../draw2d/color.hpp"
+#include "../draw2d/image.hpp"
+
+
+// Image that owns its pixels, for building test inputs in memory.
+class TestImage final : public ImageRGBA
+{
+	public:
+		TestImage( Index aWidth, Index aHeight );
+		~TestImage();
+
+	public:
+		void set_pixel( Index aX, Index aY, ColorU8_sRGB_Alpha );
+};
+
+// Random colors and alpha values. About half of the pixels fail the alpha
+// test of blit_masked(), some of them with alpha right at the threshold.
+std::unique_ptr<TestImage> make_noise_image( ImageRGBA::Index aWidth, ImageRGBA::Index aHeight, unsigned aSeed );
+
+// Copy of a sub-rectangle of an image
+std::unique_ptr<TestImage> crop_image( ImageRGBA const&, ImageRGBA::Index aX, ImageRGBA::Index aY, ImageRGBA::Index aWidth, ImageRGBA::Index aHeight );
+
+// Fill with a pattern, so that pixels that a blit does not write can be told
+// apart from pixels that it writes.
+void fill_pattern( Surface& );
+
+// Number of pixels whose RGB values differ
+std::size_t count_differences( Surface const&, Surface const& );
+
+ColorU8_sRGB get_pixel( Surface const&, std::uint32_t aX, std::uint32_t aY );
+
+#endif // HELPERS_HPP_5E0B8C27_41D3_4A96_9F2E_B7C63D18A4F0
@@ -0,0 +1,198 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <filesystem>
+
+#include <cstring>
+
+#include "../draw2d/image.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	// Fresh temporary directory with a copy of a (small) asset. Removed again
+	// at the end of the test.
+	struct TempDir_
+	{
+		TempDir_()
+		{
+			auto const now = std::chrono::steady_clock::now().time_since_epoch().count();
+			root = fs::temp_directory_path() / ("blit-test-cache-" + std::to_string( now ));
+			fs::create_directories( root );
+
+			source = root / "source.png";
+			cache = root / "cache";
+			fs::copy_file( "assets/phone.png", source );
+		}
+		~TempDir_()
+		{
+			std::error_code ec;
+			fs::remove_all( root, ec );
+		}
+
+		fs::path root, source, cache;
+	};
+
+	bool same_pixels_( ImageRGBA const& aA, ImageRGBA const& aB )
+	{
+		if( aA.get_width() != aB.get_width() || aA.get_height() != aB.get_height() )
+			return false;
+
+		std::size_t const bytes = std::size_t(aA.get_width()) * aA.get_height() * 4;
+		return 0 == std::memcmp( aA.get_image_ptr(), aB.get_image_ptr(), bytes );
+	}
+
+	// The single entry in the cache directory
+	fs::path find_entry_( fs::path const& aCache )
+	{
+		fs::path ret;
+		for( auto const& entry : fs::directory_iterator( aCache ) )
+		{
+			if( ".rgba" == entry.path().extension() )
+			{
+				REQUIRE( ret.empty() );
+				ret = entry.path();
+			}
+		}
+
+		REQUIRE( !ret.empty() );
+		return ret;
+	}
+
+	std::size_t count_temporaries_( fs::path const& aCache )
+	{
+		std::size_t count = 0;
+		for( auto const& entry : fs::directory_iterator( aCache ) )
+		{
+			if( ".tmp" == entry.path().extension() )
+				++count;
+		}
+		return count;
+	}
+
+	// Invert the last few bytes of the pixel data. The header stays intact,
+	// so a load that returns these pixels was served from the cache.
+	void tamper_pixels_( fs::path const& aEntry )
+	{
+		std::fstream fs( aEntry, std::ios::in | std::ios::out | std::ios::binary );
+		REQUIRE( fs );
+
+		char bytes[16];
+		fs.seekg( -std::streamoff(sizeof(bytes)), std::ios::end );
+		fs.read( bytes, sizeof(bytes) );
+		for( auto& byte : bytes )
+			byte = char(~byte);
+
+		fs.seekp( -std::streamoff(sizeof(bytes)), std::ios::end );
+		fs.write( bytes, sizeof(bytes) );
+		REQUIRE( fs );
+	}
+}
+
+TEST_CASE( "Image cache", "[image]" )
+{
+	TempDir_ const dir;
+
+	std::string const source = dir.source.string();
+	std::string const cache = dir.cache.string();
+
+	auto const reference = load_image( source.c_str() );
+
+	auto const first = load_image_cached( source.c_str(), cache.c_str() );
+	REQUIRE( same_pixels_( *reference, *first ) );
+
+	auto const entry = find_entry_( dir.cache );
+	REQUIRE( 0 == count_temporaries_( dir.cache ) );
+
+	SECTION( "valid entries are used" )
+	{
+		tamper_pixels_( entry );
+
+		auto const image = load_image_cached( source.c_str(), cache.c_str() );
+		REQUIRE( !same_pixels_( *reference, *image ) );
+	}
+
+	SECTION( "modification time" )
+	{
+		tamper_pixels_( entry );
+		fs::last_write_time( dir.source, fs::last_write_time( dir.source ) + std::chrono::hours( 1 ) );
+
+		auto const image = load_image_cached( source.c_str(), cache.c_str() );
+		REQUIRE( same_pixels_( *reference, *image ) );
+
+		// The entry was rewritten for the new time.
+		tamper_pixels_( entry );
+		auto const again = load_image_cached( source.c_str(), cache.c_str() );
+		REQUIRE( !same_pixels_( *reference, *again ) );
+	}
+
+	SECTION( "file size" )
+	{
+		// Trailing bytes after the PNG's end are ignored by the decoder. Keep
+		// the old modification time, so that only the size changes.
+		tamper_pixels_( entry );
+
+		auto const time = fs::last_write_time( dir.source );
+		{
+			std::ofstream ofs( dir.source, std::ios::binary | std::ios::app );
+			ofs << "trailing bytes";
+		}
+		fs::last_write_time( dir.source, time );
+
+		auto const expected = load_image( source.c_str() );
+		auto const image = load_image_cached( source.c_str(), cache.c_str() );
+		REQUIRE( same_pixels_( *expected, *image ) );
+	}
+
+	SECTION( "truncated entry" )
+	{
+		auto const size = fs::file_size( entry );
+		fs::resize_file( entry, size - 1 );
+
+		auto const image = load_image_cached( source.c_str(), cache.c_str() );
+		REQUIRE( same_pixels_( *reference, *image ) );
+		REQUIRE( size == fs::file_size( entry ) );
+	}
+
+	SECTION( "header only" )
+	{
+		fs::resize_file( entry, 16 );
+
+		auto const image = load_image_cached( source.c_str(), cache.c_str() );
+		REQUIRE( same_pixels_( *reference, *image ) );
+	}
+
+	SECTION( "corrupt magic" )
+	{
+		{
+			std::fstream fs( entry, std::ios::in | std::ios::out | std::ios::binary );
+			fs.write( "XXXX", 4 );
+		}
+
+		auto const image = load_image_cached( source.c_str(), cache.c_str() );
+		REQUIRE( same_pixels_( *reference, *image ) );
+
+		// Rewritten with a valid header
+		tamper_pixels_( entry );
+		auto const again = load_image_cached( source.c_str(), cache.c_str() );
+		REQUIRE( !same_pixels_( *reference, *again ) );
+	}
+
+	SECTION( "no partial entries" )
+	{
+		// Put a (non-empty) directory where the entry goes. Renaming the
+		// temporary file into place fails, and the temporary file must not be
+		// left behind.
+		fs::remove( entry );
+		fs::create_directories( entry / "blocker" );
+
+		auto const image = load_image_cached( source.c_str(), cache.c_str() );
+		REQUIRE( same_pixels_( *reference, *image ) );
+
+		REQUIRE( fs::is_directory( entry ) );
+		REQUIRE( 0 == count_temporaries_( dir.cache ) );
+	}
+}
@@ -0,0 +1,160 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cstdlib>
+
+#include "helpers.hpp"
+
+#include "../draw2d/image.hpp"
+#include "../draw2d/mipmap.hpp"
+#include "../draw2d/surface.hpp"
+
+TEST_CASE( "Mip chains", "[mipmap]" )
+{
+	SECTION( "level sizes" )
+	{
+		auto const image = make_noise_image( 36, 22, 1 );
+		auto const chain = make_mip_chain( *image );
+
+		ImageRGBA::Index const widths[] = { 18, 9, 4, 2, 1 };
+		ImageRGBA::Index const heights[] = { 11, 5, 2, 1, 1 };
+
+		REQUIRE( 5 == chain.size() );
+		for( std::size_t i = 0; i < chain.size(); ++i )
+		{
+			REQUIRE( widths[i] == chain[i]->get_width() );
+			REQUIRE( heights[i] == chain[i]->get_height() );
+		}
+	}
+
+	SECTION( "alpha weighting" )
+	{
+		// One opaque texel: the color is not darkened by the (white or
+		// black) transparent ones. Alpha is the plain average.
+		TestImage image( 2, 2 );
+		image.set_pixel( 0, 0, { 255, 0, 0, 255 } );
+		image.set_pixel( 1, 0, { 255, 255, 255, 0 } );
+		image.set_pixel( 0, 1, { 0, 0, 0, 0 } );
+		image.set_pixel( 1, 1, { 0, 0, 0, 0 } );
+
+		auto const chain = make_mip_chain( image );
+		REQUIRE( 1 == chain.size() );
+
+		auto const texel = chain[0]->get_pixel( 0, 0 );
+		REQUIRE( 255 == int(texel.r) );
+		REQUIRE( 0 == int(texel.g) );
+		REQUIRE( 0 == int(texel.b) );
+		REQUIRE( 64 == int(texel.a) );
+	}
+
+	SECTION( "linear average" )
+	{
+		// Black and white average to 0.5 in linear RGB, i.e., 188 in sRGB.
+		// With weights 3:1, the result is 0.75 (225 in sRGB). The levels are
+		// encoded with the batched conversion, which is within one LSB.
+		TestImage image( 4, 2 );
+		image.set_pixel( 0, 0, { 255, 255, 255, 255 } );
+		image.set_pixel( 1, 0, { 0, 0, 0, 255 } );
+		image.set_pixel( 0, 1, { 255, 255, 255, 255 } );
+		image.set_pixel( 1, 1, { 0, 0, 0, 255 } );
+
+		image.set_pixel( 2, 0, { 255, 255, 255, 255 } );
+		image.set_pixel( 3, 0, { 0, 0, 0, 85 } );
+		image.set_pixel( 2, 1, { 0, 0, 0, 0 } );
+		image.set_pixel( 3, 1, { 0, 0, 0, 0 } );
+
+		auto const chain = make_mip_chain( image );
+		auto const& level = *chain[0];
+
+		REQUIRE( std::abs( 188 - int(level.get_pixel( 0, 0 ).r) ) <= 1 );
+		REQUIRE( 255 == int(level.get_pixel( 0, 0 ).a) );
+
+		REQUIRE( std::abs( 225 - int(level.get_pixel( 1, 0 ).g) ) <= 1 );
+		REQUIRE( 85 == int(level.get_pixel( 1, 0 ).a) );
+	}
+
+	SECTION( "fully transparent" )
+	{
+		TestImage image( 2, 2 );
+		for( ImageRGBA::Index y = 0; y < 2; ++y )
+		{
+			for( ImageRGBA::Index x = 0; x < 2; ++x )
+				image.set_pixel( x, y, { 255, 255, 255, 0 } );
+		}
+
+		auto const texel = make_mip_chain( image )[0]->get_pixel( 0, 0 );
+		REQUIRE( 0 == int(texel.a) );
+	}
+}
+
+TEST_CASE( "Scaled blits", "[mipmap]" )
+{
+	auto const image = make_noise_image( 36, 22, 2 );
+	auto const chain = make_mip_chain( *image );
+	auto const mips = make_sprite_mips( *image );
+
+	REQUIRE( chain.size()+1 == mips.level_count() );
+
+	Vec2f const positions[] = {
+		{ 0.f, 0.f },
+		{ 6.f, 4.f },
+		{ -7.f, 3.f },
+		{ 25.f, 19.f },
+		{ 2.f, -9.5f },
+		{ 60.f, 0.f }
+	};
+
+	Surface expected( 40, 30 ), actual( 40, 30 );
+
+	SECTION( "scale 1 is blit_masked" )
+	{
+		for( auto const pos : positions )
+		{
+			fill_pattern( expected );
+			fill_pattern( actual );
+
+			blit_masked( expected, *image, pos );
+			blit_masked_scaled( actual, mips, pos, 1.f );
+
+			INFO( "position " << pos.x << ", " << pos.y );
+			REQUIRE( 0 == count_differences( expected, actual ) );
+		}
+	}
+
+	SECTION( "scale 1/2 is blit_masked of level 1" )
+	{
+		for( auto const pos : positions )
+		{
+			fill_pattern( expected );
+			fill_pattern( actual );
+
+			blit_masked( expected, *chain[0], pos );
+			blit_masked_scaled( actual, mips, pos, 0.5f );
+
+			INFO( "position " << pos.x << ", " << pos.y );
+			REQUIRE( 0 == count_differences( expected, actual ) );
+		}
+	}
+
+	SECTION( "scale 2 repeats texels" )
+	{
+		fill_pattern( expected );
+		fill_pattern( actual );
+
+		blit_masked_scaled( actual, mips, { 1.f, 2.f }, 2.f );
+
+		for( Surface::Index y = 0; y < 28; ++y )
+		{
+			for( Surface::Index x = 0; x < 39; ++x )
+			{
+				auto const texel = image->get_pixel( x/2, y/2 );
+				auto const want = texel.a >= 128 ? ColorU8_sRGB{ texel.r, texel.g, texel.b } : get_pixel( expected, x+1, y+2 );
+				auto const got = get_pixel( actual, x+1, y+2 );
+
+				INFO( "pixel " << x << ", " << y );
+				REQUIRE( int(want.r) == int(got.r) );
+				REQUIRE( int(want.g) == int(got.g) );
+				REQUIRE( int(want.b) == int(got.b) );
+			}
+		}
+	}
+}
@@ -0,0 +1,156 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cstring>
+
+#include "helpers.hpp"
+
+#include "../draw2d/image.hpp"
+#include "../draw2d/sprite.hpp"
+#include "../draw2d/surface.hpp"
+
+namespace
+{
+	// Positions that clip the blit on each side, and some that miss the
+	// surface completely. Fractional parts are truncated towards zero.
+	Vec2f const kPositions[] = {
+		{ 0.f, 0.f },
+		{ 10.f, 7.f },
+		{ -5.5f, 3.f },
+		{ 20.f, 10.f },
+		{ 3.f, -15.7f },
+		{ 30.f, -8.f },
+		{ -36.f, 2.f },
+		{ -40.f, 0.f },
+		{ 0.f, 100.f }
+	};
+
+	std::uint32_t pack_( std::uint8_t aR, std::uint8_t aG, std::uint8_t aB, std::uint8_t aX )
+	{
+		std::uint8_t const bytes[4] = { aR, aG, aB, aX };
+
+		std::uint32_t word;
+		std::memcpy( &word, bytes, sizeof(word) );
+		return word;
+	}
+}
+
+TEST_CASE( "Sprite blits", "[sprite]" )
+{
+	auto const image = make_noise_image( 37, 23, 1 );
+	auto const sprite = make_sprite( *image );
+
+	Surface expected( 40, 30 ), actual( 40, 30 );
+
+	SECTION( "same as blit_masked" )
+	{
+		for( auto const pos : kPositions )
+		{
+			fill_pattern( expected );
+			fill_pattern( actual );
+
+			blit_masked( expected, *image, pos );
+			blit_masked( actual, sprite, pos );
+
+			INFO( "position " << pos.x << ", " << pos.y );
+			REQUIRE( 0 == count_differences( expected, actual ) );
+		}
+	}
+
+	SECTION( "sub-rectangle" )
+	{
+		SpriteRect const rect{ 4, 2, 20, 17 };
+		auto const cropped = crop_image( *image, rect.x, rect.y, rect.width, rect.height );
+
+		for( auto const pos : kPositions )
+		{
+			fill_pattern( expected );
+			fill_pattern( actual );
+
+			blit_masked( expected, *cropped, pos );
+			blit_masked( actual, sprite, rect, pos );
+
+			INFO( "position " << pos.x << ", " << pos.y );
+			REQUIRE( 0 == count_differences( expected, actual ) );
+		}
+	}
+
+	SECTION( "fully transparent" )
+	{
+		TestImage clear( 8, 8 );
+		for( ImageRGBA::Index y = 0; y < 8; ++y )
+		{
+			for( ImageRGBA::Index x = 0; x < 8; ++x )
+				clear.set_pixel( x, y, { 255, 255, 255, std::uint8_t(x+y*16) } );
+		}
+
+		fill_pattern( expected );
+		fill_pattern( actual );
+
+		blit_masked( actual, make_sprite( clear ), { 5.f, 5.f } );
+		REQUIRE( 0 == count_differences( expected, actual ) );
+	}
+}
+
+TEST_CASE( "Sprite conversion", "[sprite]" )
+{
+	std::uint32_t const transparent = SpriteRGBx::kTransparent;
+
+	SECTION( "alpha test" )
+	{
+		TestImage image( 2, 1 );
+		image.set_pixel( 0, 0, { 10, 20, 30, 127 } );
+		image.set_pixel( 1, 0, { 40, 50, 60, 128 } );
+
+		auto const sprite = make_sprite( image );
+		REQUIRE( 0 != (sprite.get_row_ptr( 0 )[0] & transparent) );
+		REQUIRE( pack_( 40, 50, 60, 0 ) == sprite.get_row_ptr( 0 )[1] );
+	}
+
+	SECTION( "color bleeding" )
+	{
+		// One opaque pixel at (1,1). Its eight neighbours take its color;
+		// pixels further away keep the plain transparent value.
+		TestImage image( 5, 3 );
+		for( ImageRGBA::Index y = 0; y < 3; ++y )
+		{
+			for( ImageRGBA::Index x = 0; x < 5; ++x )
+				image.set_pixel( x, y, { 255, 255, 255, 0 } );
+		}
+		image.set_pixel( 1, 1, { 200, 100, 50, 255 } );
+
+		auto const sprite = make_sprite( image );
+
+		for( SpriteRGBx::Index y = 0; y < 3; ++y )
+		{
+			for( SpriteRGBx::Index x = 0; x < 5; ++x )
+			{
+				INFO( "pixel " << x << ", " << y );
+				auto const word = sprite.get_row_ptr( y )[x];
+
+				if( 1 == x && 1 == y )
+					REQUIRE( pack_( 200, 100, 50, 0 ) == word );
+				else if( x <= 2 )
+					REQUIRE( (pack_( 200, 100, 50, 0 ) | transparent) == word );
+				else
+					REQUIRE( transparent == word );
+			}
+		}
+	}
+
+	SECTION( "bleeding picks an opaque neighbour" )
+	{
+		// Masked-out pixels between two opaque ones take one of their colors,
+		// never that of another masked-out pixel.
+		TestImage image( 3, 1 );
+		image.set_pixel( 0, 0, { 10, 10, 10, 255 } );
+		image.set_pixel( 1, 0, { 99, 99, 99, 0 } );
+		image.set_pixel( 2, 0, { 20, 20, 20, 255 } );
+
+		auto const sprite = make_sprite( image );
+		auto const word = sprite.get_row_ptr( 0 )[1];
+
+		bool const fromLeft = (pack_( 10, 10, 10, 0 ) | transparent) == word;
+		bool const fromRight = (pack_( 20, 20, 20, 0 ) | transparent) == word;
+		REQUIRE( (fromLeft || fromRight) );
+	}
+}
@@ -0,0 +1,218 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+
+#include <cmath>
+
+#include "helpers.hpp"
+
+#include "../draw2d/image.hpp"
+#include "../draw2d/sprite.hpp"
+#include "../draw2d/surface.hpp"
+#include "../draw2d/transform_blit.hpp"
+
+namespace
+{
+	// Opaque image where each texel has a different color
+	std::unique_ptr<TestImage> make_opaque_( ImageRGBA::Index aWidth, ImageRGBA::Index aHeight )
+	{
+		auto ret = std::make_unique<TestImage>( aWidth, aHeight );
+		for( ImageRGBA::Index y = 0; y < aHeight; ++y )
+		{
+			for( ImageRGBA::Index x = 0; x < aWidth; ++x )
+				ret->set_pixel( x, y, { std::uint8_t(40*x+10), std::uint8_t(60*y+20), std::uint8_t(x^y), 255 } );
+		}
+		return ret;
+	}
+
+	void require_texel_( Surface const& aSurface, Surface::Index aX, Surface::Index aY, ImageRGBA const& aImage, ImageRGBA::Index aU, ImageRGBA::Index aV )
+	{
+		auto const got = get_pixel( aSurface, aX, aY );
+		auto const want = aImage.get_pixel( aU, aV );
+
+		INFO( "pixel " << aX << ", " << aY << " vs texel " << aU << ", " << aV );
+		REQUIRE( int(want.r) == int(got.r) );
+		REQUIRE( int(want.g) == int(got.g) );
+		REQUIRE( int(want.b) == int(got.b) );
+	}
+}
+
+TEST_CASE( "Transformed blits", "[transform]" )
+{
+	Mat22f const identity{ 1.f, 0.f, 0.f, 1.f };
+
+	Surface expected( 40, 30 ), actual( 40, 30 );
+
+	SECTION( "identity is blit_masked" )
+	{
+		// The image's center goes to the translation. With an integer
+		// corner position, this draws the same pixels as blit_masked().
+		auto const image = make_noise_image( 17, 12, 1 );
+		auto const sprite = make_sprite( *image );
+
+		Vec2f const half{ 0.5f * 17.f, 0.5f * 12.f };
+		Vec2f const corners[] = {
+			{ 0.f, 0.f },
+			{ 11.f, 6.f },
+			{ -5.f, 3.f },
+			{ 30.f, 25.f },
+			{ 4.f, -9.f },
+			{ -20.f, 0.f }
+		};
+
+		for( auto const corner : corners )
+		{
+			INFO( "corner " << corner.x << ", " << corner.y );
+
+			fill_pattern( expected );
+			blit_masked( expected, *image, corner );
+
+			fill_pattern( actual );
+			blit_transformed( actual, *image, identity, corner + half );
+			REQUIRE( 0 == count_differences( expected, actual ) );
+
+			fill_pattern( actual );
+			blit_transformed( actual, sprite, identity, corner + half, ESampleMode::nearest );
+			REQUIRE( 0 == count_differences( expected, actual ) );
+
+			// Pixel centers hit texel centers, so the filter weights are zero.
+			fill_pattern( actual );
+			blit_transformed( actual, sprite, identity, corner + half, ESampleMode::bilinear );
+			REQUIRE( 0 == count_differences( expected, actual ) );
+		}
+	}
+
+	SECTION( "rotation by 90 degrees" )
+	{
+		// Local (x,y) maps to (-y,x). The 4x2 image centered at (10,10)
+		// covers x in [9,11) and y in [8,12): row v=0 lands in column 10,
+		// row v=1 in column 9, and u runs upwards from y=8.
+		auto const image = make_opaque_( 4, 2 );
+
+		fill_pattern( expected );
+		fill_pattern( actual );
+		blit_transformed( actual, *image, Mat22f{ 0.f, -1.f, 1.f, 0.f }, { 10.f, 10.f } );
+
+		for( Surface::Index y = 8; y < 12; ++y )
+		{
+			require_texel_( actual, 9, y, *image, y-8, 1 );
+			require_texel_( actual, 10, y, *image, y-8, 0 );
+		}
+
+		// Nothing else is touched.
+		for( Surface::Index y = 8; y < 12; ++y )
+		{
+			for( Surface::Index x : { 9u, 10u } )
+			{
+				auto const color = get_pixel( expected, x, y );
+				actual.set_pixel_srgb( x, y, color );
+			}
+		}
+		REQUIRE( 0 == count_differences( expected, actual ) );
+	}
+
+	SECTION( "scaling by 2" )
+	{
+		// The 2x2 image centered at (10,10) covers [8,12)^2; each texel
+		// becomes a 2x2 block.
+		auto const image = make_opaque_( 2, 2 );
+		auto const sprite = make_sprite( *image );
+
+		Mat22f const scale{ 2.f, 0.f, 0.f, 2.f };
+
+		fill_pattern( expected );
+		fill_pattern( actual );
+		blit_transformed( actual, *image, scale, { 10.f, 10.f } );
+
+		for( Surface::Index y = 8; y < 12; ++y )
+		{
+			for( Surface::Index x = 8; x < 12; ++x )
+			{
+				require_texel_( actual, x, y, *image, (x-8)/2, (y-8)/2 );
+				actual.set_pixel_srgb( x, y, get_pixel( expected, x, y ) );
+			}
+		}
+		REQUIRE( 0 == count_differences( expected, actual ) );
+
+		// Same for the sprite
+		fill_pattern( actual );
+		blit_transformed( actual, sprite, scale, { 10.f, 10.f } );
+		for( Surface::Index y = 8; y < 12; ++y )
+		{
+			for( Surface::Index x = 8; x < 12; ++x )
+				require_texel_( actual, x, y, *image, (x-8)/2, (y-8)/2 );
+		}
+	}
+
+	SECTION( "sprite is image" )
+	{
+		// Nearest sampling of the sprite draws the same as the image version
+		// for arbitrary transforms, also where it is clipped.
+		auto const image = make_noise_image( 23, 14, 2 );
+		auto const sprite = make_sprite( *image );
+
+		std::minstd_rand rng( 3 );
+		std::uniform_real_distribution<float> angle( 0.f, 6.2831853f );
+		std::uniform_real_distribution<float> scale( 0.3f, 2.5f );
+		std::uniform_real_distribution<float> pos( -10.f, 50.f );
+
+		for( int i = 0; i < 50; ++i )
+		{
+			float const a = angle( rng ), s = scale( rng );
+			Mat22f const xform{ s*std::cos( a ), -s*std::sin( a ), s*std::sin( a ), s*std::cos( a ) };
+			Vec2f const t{ pos( rng ), pos( rng ) };
+
+			fill_pattern( expected );
+			fill_pattern( actual );
+
+			blit_transformed( expected, *image, xform, t );
+			blit_transformed( actual, sprite, xform, t );
+
+			INFO( "iteration " << i );
+			REQUIRE( 0 == count_differences( expected, actual ) );
+		}
+	}
+}
+
+TEST_CASE( "Bilinear filter", "[transform]" )
+{
+	SECTION( "corners" )
+	{
+		std::uint32_t const p00 = 0x11223344u, p10 = 0x55667788u, p01 = 0x99aabbccu, p11 = 0xddeeff00u;
+
+		REQUIRE( p00 == detail::bilerp( p00, p10, p01, p11, 0, 0 ) );
+		REQUIRE( p00 == detail::bilerp_scalar( p00, p10, p01, p11, 0, 0 ) );
+	}
+
+	SECTION( "SIMD matches scalar" )
+	{
+		// bilerp() is the SSE2 version where that is available.
+		std::mt19937 rng( 4 );
+		std::uniform_int_distribution<std::uint32_t> word;
+		std::uniform_int_distribution<std::uint32_t> weight( 0, 255 );
+
+		for( int i = 0; i < 100000; ++i )
+		{
+			std::uint32_t const p00 = word( rng ), p10 = word( rng ), p01 = word( rng ), p11 = word( rng );
+			std::uint32_t const fx = weight( rng ), fy = weight( rng );
+
+			auto const simd = detail::bilerp( p00, p10, p01, p11, fx, fy );
+			auto const scalar = detail::bilerp_scalar( p00, p10, p01, p11, fx, fy );
+			if( simd != scalar )
+			{
+				INFO( std::hex << p00 << " " << p10 << " " << p01 << " " << p11 << " " << fx << " " << fy );
+				REQUIRE( scalar == simd );
+			}
+		}
+
+		// Extreme weights and values
+		for( std::uint32_t fx : { 0u, 1u, 128u, 255u } )
+		{
+			for( std::uint32_t fy : { 0u, 1u, 128u, 255u } )
+			{
+				REQUIRE( detail::bilerp_scalar( ~0u, ~0u, ~0u, ~0u, fx, fy ) == detail::bilerp( ~0u, ~0u, ~0u, ~0u, fx, fy ) );
+				REQUIRE( detail::bilerp_scalar( 0u, ~0u, ~0u, 0u, fx, fy ) == detail::bilerp( 0u, ~0u, ~0u, 0u, fx, fy ) );
+			}
+		}
+	}
+}
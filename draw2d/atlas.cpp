@@ -0,0 +1,167 @@
+#include "atlas.hpp"
+
+#include <cmath>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+
+#include <cassert>
+#include <cstring>
+
+#include "image.hpp"
+#include "surface.hpp"
+
+namespace
+{
+	struct Trimmed_
+	{
+		SpriteRGBx sprite;
+		int minX, minY; // First opaque column/row
+		int width, height; // Size of tight rectangle (0 if fully transparent)
+	};
+
+	Trimmed_ trim_( ImageRGBA const& );
+}
+
+SpriteAtlas::SpriteAtlas( SpriteRGBx&& aSprite, std::vector<Entry>&& aEntries )
+	: mSprite( std::move( aSprite ) )
+	, mEntries( std::move( aEntries ) )
+{}
+
+
+SpriteAtlas make_sprite_atlas( std::size_t aCount, ImageRGBA const* const* aImages )
+{
+	assert( aImages || 0 == aCount );
+
+	// Convert and trim each image.
+	std::vector<Trimmed_> trimmed;
+	trimmed.reserve( aCount );
+
+	std::size_t totalArea = 0;
+	int maxWidth = 0;
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		assert( aImages[i] );
+		trimmed.emplace_back( trim_( *aImages[i] ) );
+
+		auto const& t = trimmed.back();
+		totalArea += std::size_t(t.width) * t.height;
+		maxWidth = std::max( maxWidth, t.width );
+	}
+
+	// Shelf packing. Taller rectangles go first, so that each shelf wastes
+	// little space above its shorter members.
+	int const atlasWidth = std::max( maxWidth, int(std::ceil( std::sqrt( double(totalArea) ) )) );
+
+	std::vector<std::size_t> order( aCount );
+	std::iota( order.begin(), order.end(), std::size_t(0) );
+	std::stable_sort( order.begin(), order.end(), [&] (std::size_t aA, std::size_t aB) {
+		return trimmed[aA].height > trimmed[aB].height;
+	} );
+
+	std::vector<SpriteAtlas::Entry> entries( aCount );
+
+	int shelfX = 0, shelfY = 0, shelfHeight = 0;
+	for( auto const idx : order )
+	{
+		auto const& t = trimmed[idx];
+
+		if( shelfX + t.width > atlasWidth )
+		{
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+
+		auto& entry = entries[idx];
+		entry.rect = SpriteRect{
+			SpriteAtlas::Index(shelfX), SpriteAtlas::Index(shelfY),
+			SpriteAtlas::Index(t.width), SpriteAtlas::Index(t.height)
+		};
+		entry.offsetX = t.minX;
+		entry.offsetY = t.minY;
+		entry.sourceWidth = t.sprite.get_width();
+		entry.sourceHeight = t.sprite.get_height();
+
+		shelfX += t.width;
+		shelfHeight = std::max( shelfHeight, t.height );
+	}
+
+	int const atlasHeight = shelfY + shelfHeight;
+
+	// Copy pixels. Space between the packed rectangles stays transparent.
+	auto const width = SpriteAtlas::Index(atlasWidth);
+	auto const height = SpriteAtlas::Index(atlasHeight);
+
+	SpriteRGBx atlas( width, height );
+	for( int y = 0; y < atlasHeight; ++y )
+	{
+		std::uint32_t* row = atlas.get_row_ptr( SpriteAtlas::Index(y) );
+		std::fill_n( row, atlasWidth, SpriteRGBx::kTransparent );
+	}
+
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		auto const& t = trimmed[i];
+		auto const& rect = entries[i].rect;
+
+		for( int y = 0; y < t.height; ++y )
+		{
+			std::uint32_t const* src = t.sprite.get_row_ptr( SpriteAtlas::Index(t.minY + y) ) + t.minX;
+			std::uint32_t* dst = atlas.get_row_ptr( rect.y + SpriteAtlas::Index(y) ) + rect.x;
+			std::memcpy( dst, src, sizeof(std::uint32_t)*t.width );
+		}
+	}
+
+	return SpriteAtlas( std::move(atlas), std::move(entries) );
+}
+
+void blit_masked( Surface& aSurface, SpriteAtlas const& aAtlas, SpriteAtlas::Handle aHandle, Vec2f aPosition )
+{
+	auto const& entry = aAtlas.get_entry( aHandle );
+
+	// Place the trimmed rectangle where it would have been in the untrimmed
+	// image. Convert the position first, so that the result matches
+	// blit_masked() with the original image exactly.
+	int const x = static_cast<int>(aPosition.x) + entry.offsetX;
+	int const y = static_cast<int>(aPosition.y) + entry.offsetY;
+
+	detail::blit_masked_rect( aSurface, aAtlas.get_sprite(), entry.rect, x, y );
+}
+
+namespace
+{
+	Trimmed_ trim_( ImageRGBA const& aImage )
+	{
+		Trimmed_ ret{ make_sprite( aImage ), 0, 0, 0, 0 };
+
+		int const width = int(ret.sprite.get_width());
+		int const height = int(ret.sprite.get_height());
+
+		int minX = width, minY = height, maxX = -1, maxY = -1;
+		for( int y = 0; y < height; ++y )
+		{
+			std::uint32_t const* row = ret.sprite.get_row_ptr( SpriteRGBx::Index(y) );
+			for( int x = 0; x < width; ++x )
+			{
+				if( row[x] & SpriteRGBx::kTransparent )
+					continue;
+
+				minX = std::min( minX, x );
+				maxX = std::max( maxX, x );
+				minY = std::min( minY, y );
+				maxY = std::max( maxY, y );
+			}
+		}
+
+		if( maxX >= 0 )
+		{
+			ret.minX = minX;
+			ret.minY = minY;
+			ret.width = maxX - minX + 1;
+			ret.height = maxY - minY + 1;
+		}
+
+		return ret;
+	}
+}
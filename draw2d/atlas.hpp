@@ -0,0 +1,85 @@
+#ifndef ATLAS_HPP_9C3E5F71_2A8D_4B6E_8F14_D05B7E3A6C29
+#define ATLAS_HPP_9C3E5F71_2A8D_4B6E_8F14_D05B7E3A6C29
+
+#include <vector>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+#include "forward.hpp"
+#include "sprite.hpp"
+
+#include "../vmlib/vec2.hpp"
+
+/** SpriteAtlas - several sprites packed into a single SpriteRGBx
+ *
+ * The atlas is built at load time from a set of images. Each image is first
+ * trimmed to the tight rectangle around its opaque pixels (i.e., pixels that
+ * pass the blit_masked() alpha test); fully transparent borders are dropped.
+ * The trimmed rectangles are then packed into one SpriteRGBx.
+ *
+ * All sprites thus share a single allocation. Individual sprites are
+ * addressed by handles; the handle of a sprite is the index of its image in
+ * the list passed to make_sprite_atlas().
+ */
+class SpriteAtlas final
+{
+	public:
+		using Index = SpriteRGBx::Index;
+		using Handle = std::size_t;
+
+		struct Entry
+		{
+			SpriteRect rect; // Location in the atlas
+			int offsetX, offsetY; // Trimmed amount (relative to the source image)
+			Index sourceWidth, sourceHeight; // Untrimmed size of the source image
+		};
+
+	public:
+		SpriteAtlas( SpriteRGBx&&, std::vector<Entry>&& );
+
+		// Move-only, like SpriteRGBx.
+		SpriteAtlas( SpriteAtlas const& ) = delete;
+		SpriteAtlas& operator= (SpriteAtlas const&) = delete;
+
+		SpriteAtlas( SpriteAtlas&& ) noexcept = default;
+		SpriteAtlas& operator= (SpriteAtlas&&) noexcept = default;
+
+	public:
+		std::size_t size() const noexcept { return mEntries.size(); }
+
+		Entry const& get_entry( Handle aHandle ) const noexcept
+		{
+			assert( aHandle < mEntries.size() );
+			return mEntries[aHandle];
+		}
+
+		SpriteRGBx const& get_sprite() const noexcept { return mSprite; }
+
+	private:
+		SpriteRGBx mSprite;
+		std::vector<Entry> mEntries;
+};
+
+/** Pack images into a SpriteAtlas
+ *
+ * Uses a shelf packer: trimmed rectangles are sorted by height and placed
+ * left-to-right in rows ("shelves"). The atlas width is picked to make the
+ * result roughly square, but is at least as wide as the widest sprite.
+ */
+SpriteAtlas make_sprite_atlas( std::size_t aCount, ImageRGBA const* const* aImages );
+
+/** Blit sprite aHandle from the atlas, at position aPosition
+ *
+ * Produces the same result as blit_masked() with the original image at the
+ * same position; the trimmed borders are accounted for.
+ */
+void blit_masked(
+	Surface&,
+	SpriteAtlas const&,
+	SpriteAtlas::Handle,
+	Vec2f aPosition
+);
+
+#endif // ATLAS_HPP_9C3E5F71_2A8D_4B6E_8F14_D05B7E3A6C29
@@ -0,0 +1,192 @@
+#include "color.hpp"
+
+#include <algorithm>
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define DRAW2D_COLOR_SSE2 1
+#	include <emmintrin.h>
+#endif
+
+// The AoS overloads treat the colors as a flat sequence of channel values.
+static_assert( sizeof(ColorF) == 3*sizeof(float), "ColorF must be three packed floats" );
+static_assert( sizeof(ColorU8_sRGB) == 3, "ColorU8_sRGB must be three packed bytes" );
+
+namespace
+{
+	// Number of channel values converted per block by the AoS overloads.
+	constexpr std::size_t kBlockSize = 3*64;
+
+	float srgb_decode_exact_( std::uint8_t ) noexcept;
+	std::uint8_t srgb_encode_exact_( float ) noexcept;
+
+	std::array<float,256> const& decode_table_();
+
+#	if defined(DRAW2D_COLOR_SSE2)
+	// Encodes 16 values (aLinear[0..15]) to aSrgb[0..15].
+	void encode16_( float const* aLinear, std::uint8_t* aSrgb ) noexcept;
+#	endif // ~ SSE2
+}
+
+void linear_to_srgb( std::size_t aCount, float const* aLinear, std::uint8_t* aSrgb ) noexcept
+{
+	std::size_t i = 0;
+
+#	if defined(DRAW2D_COLOR_SSE2)
+	for( ; i + 16 <= aCount; i += 16 )
+		encode16_( aLinear + i, aSrgb + i );
+
+	if( i < aCount )
+	{
+		// Pad the remaining values to a full block, such that the tail gets
+		// the same results as the bulk.
+		float tail[16] = {};
+		std::uint8_t out[16];
+
+		std::copy( aLinear + i, aLinear + aCount, tail );
+		encode16_( tail, out );
+		std::copy( out, out + (aCount - i), aSrgb + i );
+	}
+#	else // !SSE2
+	for( ; i < aCount; ++i )
+		aSrgb[i] = srgb_encode_exact_( aLinear[i] );
+#	endif // ~ SSE2
+}
+
+void linear_from_srgb( std::size_t aCount, std::uint8_t const* aSrgb, float* aLinear ) noexcept
+{
+	auto const& table = decode_table_();
+	for( std::size_t i = 0; i < aCount; ++i )
+		aLinear[i] = table[aSrgb[i]];
+}
+
+void linear_to_srgb( std::size_t aCount, ColorF const* aLinear, ColorU8_sRGB* aSrgb ) noexcept
+{
+	// All channels go through the same curve, so convert blocks of colors as
+	// flat arrays. The copies avoid type punning between ColorF and float.
+	float values[kBlockSize];
+	std::uint8_t codes[kBlockSize];
+
+	for( std::size_t i = 0; i < aCount; i += kBlockSize/3 )
+	{
+		std::size_t const count = std::min( aCount - i, kBlockSize/3 );
+
+		std::memcpy( values, aLinear + i, sizeof(ColorF)*count );
+		linear_to_srgb( 3*count, values, codes );
+		std::memcpy( aSrgb + i, codes, sizeof(ColorU8_sRGB)*count );
+	}
+}
+
+void linear_from_srgb( std::size_t aCount, ColorU8_sRGB const* aSrgb, ColorF* aLinear ) noexcept
+{
+	auto const& table = decode_table_();
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		aLinear[i] = ColorF{
+			table[aSrgb[i].r],
+			table[aSrgb[i].g],
+			table[aSrgb[i].b]
+		};
+	}
+}
+
+namespace
+{
+	// Same as the EXACT mode in color.inl
+	float srgb_decode_exact_( std::uint8_t aValue ) noexcept
+	{
+		float const fvalue = float(aValue) / 255.f;
+		if( fvalue < 0.04045f )
+			return (1.f/12.92f) * fvalue;
+
+		return std::pow( (1.f/1.055f) * (fvalue + 0.055f), 2.4f );
+	}
+
+	[[maybe_unused]]
+	std::uint8_t srgb_encode_exact_( float aValue ) noexcept
+	{
+		// Written such that NaN ends up as zero.
+		float const clamped = aValue > 0.f ? (aValue < 1.f ? aValue : 1.f) : 0.f;
+		if( clamped < 0.0031308f )
+			return std::uint8_t(255.f * 12.92f * clamped + 0.5f);
+
+		return std::uint8_t(255.f * (1.055f * std::pow( clamped, 1.f/2.4f ) - 0.055f) + 0.5f);
+	}
+
+	std::array<float,256> const& decode_table_()
+	{
+		static std::array<float,256> const table = [] {
+			std::array<float,256> ret{};
+			for( std::size_t i = 0; i < ret.size(); ++i )
+				ret[i] = srgb_decode_exact_( std::uint8_t(i) );
+			return ret;
+		}();
+
+		return table;
+	}
+
+#	if defined(DRAW2D_COLOR_SSE2)
+	// x^(1/2.4) = exp2( log2(x) / 2.4 ) for x in (0,1].
+	//
+	// log2: split x into exponent e and mantissa m in [1,2); log2(m) is a
+	// degree 5 polynomial in (m-1) (max abs. error 1.7e-5). exp2: split into
+	// integer and fractional part f in [0,1); 2^f is a degree 4 polynomial
+	// (max rel. error 3.5e-6). Both are Chebyshev fits. The combined error
+	// is far below 1/255, so only values within a hair of a rounding
+	// boundary can differ from EXACT (by one).
+	__m128 pow_inv24_( __m128 aX ) noexcept
+	{
+		__m128i const bits = _mm_castps_si128( aX );
+		__m128 const e = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), _mm_set1_epi32( 127 ) ) );
+		__m128 const m = _mm_sub_ps( _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, _mm_set1_epi32( 0x007fffff ) ), _mm_set1_epi32( 0x3f800000 ) ) ), _mm_set1_ps( 1.f ) );
+
+		__m128 lm = _mm_set1_ps( 0.0430049578f );
+		lm = _mm_add_ps( _mm_mul_ps( lm, m ), _mm_set1_ps( -0.187488605f ) );
+		lm = _mm_add_ps( _mm_mul_ps( lm, m ), _mm_set1_ps( 0.409470299f ) );
+		lm = _mm_add_ps( _mm_mul_ps( lm, m ), _mm_set1_ps( -0.706486449f ) );
+		lm = _mm_add_ps( _mm_mul_ps( lm, m ), _mm_set1_ps( 1.44149241f ) );
+		lm = _mm_add_ps( _mm_mul_ps( lm, m ), _mm_set1_ps( 1.65146709e-5f ) );
+
+		// y = log2(x) / 2.4 is in [-52.5, 0]; floor() via truncation of -y.
+		__m128 const y = _mm_mul_ps( _mm_add_ps( e, lm ), _mm_set1_ps( 1.f/2.4f ) );
+		__m128i const ni = _mm_cvttps_epi32( _mm_sub_ps( _mm_setzero_ps(), y ) );
+		__m128i const ii = _mm_sub_epi32( _mm_setzero_si128(), _mm_add_epi32( ni, _mm_set1_epi32( 1 ) ) );
+		__m128 const f = _mm_sub_ps( y, _mm_cvtepi32_ps( ii ) );
+
+		__m128 p = _mm_set1_ps( 0.0136703095f );
+		p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 0.0517449978f ) );
+		p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 0.241604357f ) );
+		p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 0.692972922f ) );
+		p = _mm_add_ps( _mm_mul_ps( p, f ), _mm_set1_ps( 1.00000349f ) );
+
+		__m128 const scale = _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( ii, _mm_set1_epi32( 127 ) ), 23 ) );
+		return _mm_mul_ps( p, scale );
+	}
+
+	__m128i encode4_( __m128 aX ) noexcept
+	{
+		// Clamp to [0,1]; _mm_max_ps() returns its second operand for NaN.
+		__m128 const x = _mm_min_ps( _mm_max_ps( aX, _mm_setzero_ps() ), _mm_set1_ps( 1.f ) );
+
+		__m128 const lin = _mm_mul_ps( x, _mm_set1_ps( 12.92f ) );
+		__m128 const gam = _mm_sub_ps( _mm_mul_ps( pow_inv24_( x ), _mm_set1_ps( 1.055f ) ), _mm_set1_ps( 0.055f ) );
+
+		__m128 const isLinear = _mm_cmplt_ps( x, _mm_set1_ps( 0.0031308f ) );
+		__m128 const srgb = _mm_or_ps( _mm_and_ps( isLinear, lin ), _mm_andnot_ps( isLinear, gam ) );
+
+		return _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( srgb, _mm_set1_ps( 255.f ) ), _mm_set1_ps( 0.5f ) ) );
+	}
+
+	void encode16_( float const* aLinear, std::uint8_t* aSrgb ) noexcept
+	{
+		__m128i const a = encode4_( _mm_loadu_ps( aLinear+0 ) );
+		__m128i const b = encode4_( _mm_loadu_ps( aLinear+4 ) );
+		__m128i const c = encode4_( _mm_loadu_ps( aLinear+8 ) );
+		__m128i const d = encode4_( _mm_loadu_ps( aLinear+12 ) );
+
+		__m128i const codes = _mm_packus_epi16( _mm_packs_epi32( a, b ), _mm_packs_epi32( c, d ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(aSrgb), codes );
+	}
+#	endif // ~ SSE2
+}
@@ -1,3 +1,92 @@
+namespace detail
+{
+	constexpr std::size_t kSrgbEncodeLutSize = 4096;
+
+	// aX^(1/5) for aX in (0,1], by Newton's method (std::pow() is not
+	// constexpr). Starting above the root, the iterates decrease until they
+	// converge.
+	constexpr
+	double srgb_root5( double aX ) noexcept
+	{
+		double y = 1.0;
+		for( int i = 0; i < 64; ++i )
+		{
+			double const y4 = (y*y) * (y*y);
+			double const next = 0.2 * (4.0*y + aX/y4);
+			if( next >= y )
+				break;
+
+			y = next;
+		}
+		return y;
+	}
+
+	// EXACT sRGB to linear conversion, aValue in [0,1]. The exponent 2.4 is
+	// evaluated as x^2 * (x^2)^(1/5).
+	constexpr
+	double srgb_decode( double aValue ) noexcept
+	{
+		if( aValue < 0.04045 )
+			return aValue / 12.92;
+
+		double const base = (aValue + 0.055) / 1.055;
+		double const base2 = base * base;
+		return base2 * srgb_root5( base2 );
+	}
+
+	constexpr
+	std::array<float,256> make_srgb_decode_lut() noexcept
+	{
+		std::array<float,256> ret{};
+		for( std::size_t i = 0; i < ret.size(); ++i )
+			ret[i] = float(srgb_decode( double(i) / 255.0 ));
+		return ret;
+	}
+
+	// Entry i holds the sRGB value of the linear value i/(size-1), rounded to
+	// the nearest code. Rather than inverting the curve for each entry, walk
+	// the entries alongside the 255 linear values at which the rounded code
+	// changes (the decoded half-way points between neighbouring codes).
+	constexpr
+	std::array<std::uint8_t,kSrgbEncodeLutSize> make_srgb_encode_lut() noexcept
+	{
+		std::array<std::uint8_t,kSrgbEncodeLutSize> ret{};
+
+		unsigned code = 0;
+		double threshold = srgb_decode( 0.5 / 255.0 );
+		for( std::size_t i = 0; i < ret.size(); ++i )
+		{
+			double const value = double(i) / double(kSrgbEncodeLutSize-1);
+			while( code < 255 && value >= threshold )
+			{
+				++code;
+				threshold = code < 255 ? srgb_decode( (code + 0.5) / 255.0 ) : 2.0;
+			}
+
+			ret[i] = std::uint8_t(code);
+		}
+
+		return ret;
+	}
+
+	inline constexpr std::array<float,256> kSrgbDecodeLut = make_srgb_decode_lut();
+	inline constexpr std::array<std::uint8_t,kSrgbEncodeLutSize> kSrgbEncodeLut = make_srgb_encode_lut();
+
+	inline
+	std::uint8_t linear_to_srgb_lut( float aValue ) noexcept
+	{
+		// Written such that NaN ends up as zero.
+		float const clamped = aValue > 0.f ? (aValue < 1.f ? aValue : 1.f) : 0.f;
+		return kSrgbEncodeLut[std::size_t(clamped * float(kSrgbEncodeLutSize-1) + 0.5f)];
+	}
+
+	inline
+	float linear_from_srgb_lut( std::uint8_t aValue ) noexcept
+	{
+		return kSrgbDecodeLut[aValue];
+	}
+}
+
 inline
 std::uint8_t linear_to_srgb( float aValue ) noexcept
 {
@@ -13,12 +102,19 @@ std::uint8_t linear_to_srgb( float aValue ) noexcept
 #	elif DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_FASTER
 	return std::uint8_t(255.f * std::sqrt( aValue ) + 0.5f);
 
+#	elif DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_LUT
+	return detail::linear_to_srgb_lut( aValue );
+
 #	endif // ~ DRAW2D_CFG_SRGB_MODE
 }
 
 inline
 float linear_from_srgb( std::uint8_t aValue ) noexcept
 {
+#	if DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_LUT
+	return detail::linear_from_srgb_lut( aValue );
+
+#	else // !SRGB_LUT
 	float const fvalue = float(aValue) / 255.f;
 
 #	if DRAW2D_CFG_SRGB_MODE == DRAW2D_CFG_SRGB_EXACT
@@ -34,6 +130,7 @@ float linear_from_srgb( std::uint8_t aValue ) noexcept
 	return fvalue * fvalue;
 
 #	endif // ~ DRAW2D_CFG_SRGB_MODE
+#	endif // ~ SRGB_LUT
 
 }
 
@@ -10,5 +10,8 @@ class TriangleFan;
 class Surface;
 
 class ImageRGBA;
+class SpriteRGBx;
+class SpriteAtlas;
+class SpriteMipChain;
 
 #endif // FORWARD_HPP_D19DC0DD_871F_44A8_ACFF_2B948EAB8E7F
@@ -1,7 +1,13 @@
 #include "image.hpp"
 
+#include <mutex>
 #include <memory>
+#include <string>
+#include <random>
+#include <fstream>
 #include <algorithm>
+#include <filesystem>
+#include <system_error>
 
 #include <cstdio>
 #include <cstring>
@@ -9,6 +15,17 @@
 
 #include <stb_image.h>
 
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#else // !_WIN32
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif // ~ _WIN32
+
 #include "surface.hpp"
 
 #include "../support/error.hpp"
@@ -20,6 +37,44 @@ namespace
 		STBImageRGBA_( Index, Index, std::uint8_t* );
 		virtual ~STBImageRGBA_();
 	};
+
+	// Image whose pixels live in a memory-mapped cache file (see
+	// load_image_cached()). The mapping is private/copy-on-write, so writing
+	// to the image does not modify the cache file.
+	struct MappedImageRGBA_ : public ImageRGBA
+	{
+		MappedImageRGBA_( Index, Index, void* aMapping, std::size_t aMapSize, std::size_t aDataOffset );
+		virtual ~MappedImageRGBA_();
+
+		void* mMapping;
+		std::size_t mMapSize;
+	};
+
+	// On-disk layout of a cache entry: header, source path (for verification),
+	// zero padding up to dataOffset, and finally width*height*4 bytes of RGBA
+	// data in the same order that load_image() produces.
+	struct CacheHeader_
+	{
+		char magic[4];
+		std::uint32_t version;
+		std::uint32_t width, height;
+		std::int64_t sourceTime;
+		std::uint64_t sourceSize;
+		std::uint32_t pathLength;
+		std::uint32_t dataOffset;
+	};
+
+	constexpr char kCacheMagic[4] = { 'D', '2', 'I', 'C' };
+	constexpr std::uint32_t kCacheVersion = 1;
+	constexpr std::size_t kCacheDataAlign = 64;
+
+	std::string cache_entry_path_( char const* aPath, char const* aCacheDir );
+
+	std::unique_ptr<ImageRGBA> map_cache_entry_( std::string const&, char const* aPath, std::int64_t aTime, std::uint64_t aSize );
+	void write_cache_entry_( std::string const&, char const* aPath, std::int64_t aTime, std::uint64_t aSize, ImageRGBA const& );
+
+	void* map_file_( char const*, std::size_t& aSizeOut ) noexcept;
+	void unmap_file_( void*, std::size_t ) noexcept;
 }
 
 ImageRGBA::ImageRGBA()
@@ -35,7 +90,10 @@ std::unique_ptr<ImageRGBA> load_image( char const* aPath )
 {
 	assert( aPath );
 
-	stbi_set_flip_vertically_on_load( true );
+	// The flip flag is global state in stb_image.h. Set it once, so that
+	// concurrent loads (see load_image_async()) don't race on it.
+	static std::once_flag flipOnce;
+	std::call_once( flipOnce, [] { stbi_set_flip_vertically_on_load( true ); } );
 
 	int w, h, channels;
 	stbi_uc* ptr = stbi_load( aPath, &w, &h, &channels, 4 );
@@ -49,6 +107,52 @@ std::unique_ptr<ImageRGBA> load_image( char const* aPath )
 	);
 }
 
+std::unique_ptr<ImageRGBA> load_image_cached( char const* aPath, char const* aCacheDir )
+{
+	assert( aPath && aCacheDir );
+
+	// The cache key includes the source's modification time and size. If we
+	// can't query those, there is nothing to key on; just decode.
+	namespace fs = std::filesystem;
+
+	std::error_code ec;
+	auto const stime = fs::last_write_time( aPath, ec );
+	if( ec )
+		return load_image( aPath );
+
+	auto const ssize = fs::file_size( aPath, ec );
+	if( ec )
+		return load_image( aPath );
+
+	std::int64_t const time = std::int64_t(stime.time_since_epoch().count());
+	std::uint64_t const size = std::uint64_t(ssize);
+
+	auto const entry = cache_entry_path_( aPath, aCacheDir );
+
+	if( auto mapped = map_cache_entry_( entry, aPath, time, size ) )
+		return mapped;
+
+	// Cache miss (or stale entry): decode normally and (try to) refresh the
+	// cache for next time.
+	auto image = load_image( aPath );
+
+	fs::create_directories( aCacheDir, ec );
+	if( !ec )
+		write_cache_entry_( entry, aPath, time, size, *image );
+
+	return image;
+}
+
+std::future<std::unique_ptr<ImageRGBA>> load_image_async( char const* aPath, char const* aCacheDir )
+{
+	assert( aPath && aCacheDir );
+
+	// std::launch::async guarantees that each request runs on its own thread
+	// (rather than being deferred until get()), so multiple requests decode
+	// in parallel.
+	return std::async( std::launch::async, &load_image_cached, aPath, aCacheDir );
+}
+
 void blit_masked( Surface& aSurface, ImageRGBA const& aImage, Vec2f aPosition )
 {
 	// Getting the width and height of the image to be blitted and the surface
@@ -93,4 +197,197 @@ namespace
 		if( mData )
 			stbi_image_free( mData );
 	}
+
+
+	MappedImageRGBA_::MappedImageRGBA_( Index aWidth, Index aHeight, void* aMapping, std::size_t aMapSize, std::size_t aDataOffset )
+		: mMapping( aMapping )
+		, mMapSize( aMapSize )
+	{
+		mWidth = aWidth;
+		mHeight = aHeight;
+		mData = static_cast<std::uint8_t*>(aMapping) + aDataOffset;
+	}
+
+	MappedImageRGBA_::~MappedImageRGBA_()
+	{
+		if( mMapping )
+			unmap_file_( mMapping, mMapSize );
+	}
+
+
+	std::string cache_entry_path_( char const* aPath, char const* aCacheDir )
+	{
+		// FNV-1a over the source path. Collisions are caught when the entry is
+		// mapped, since the entry also stores the full source path.
+		std::uint64_t hash = 14695981039346656037ull;
+		for( char const* ch = aPath; *ch; ++ch )
+		{
+			hash ^= std::uint8_t(*ch);
+			hash *= 1099511628211ull;
+		}
+
+		char name[32];
+		std::snprintf( name, sizeof(name), "%016llx.rgba", static_cast<unsigned long long>(hash) );
+
+		return (std::filesystem::path( aCacheDir ) / name).string();
+	}
+
+	std::unique_ptr<ImageRGBA> map_cache_entry_( std::string const& aEntry, char const* aPath, std::int64_t aTime, std::uint64_t aSize )
+	{
+		std::size_t mapSize = 0;
+		void* mapping = map_file_( aEntry.c_str(), mapSize );
+		if( !mapping )
+			return nullptr;
+
+		auto const* bytes = static_cast<std::uint8_t const*>(mapping);
+		std::size_t const pathLength = std::strlen( aPath );
+
+		// Validate entry. Anything unexpected is treated as a miss.
+		CacheHeader_ header;
+		bool valid = mapSize >= sizeof(CacheHeader_);
+		if( valid )
+		{
+			std::memcpy( &header, bytes, sizeof(CacheHeader_) );
+
+			std::size_t const pixelBytes = std::size_t(header.width) * header.height * 4;
+			valid = 0 == std::memcmp( header.magic, kCacheMagic, sizeof(kCacheMagic) )
+				&& kCacheVersion == header.version
+				&& aTime == header.sourceTime
+				&& aSize == header.sourceSize
+				&& pathLength == header.pathLength
+				&& header.dataOffset >= sizeof(CacheHeader_) + pathLength
+				&& 0 == header.dataOffset % kCacheDataAlign
+				&& mapSize == header.dataOffset + pixelBytes
+				&& 0 == std::memcmp( bytes + sizeof(CacheHeader_), aPath, pathLength )
+			;
+		}
+
+		if( !valid )
+		{
+			unmap_file_( mapping, mapSize );
+			return nullptr;
+		}
+
+		return std::make_unique<MappedImageRGBA_>(
+			ImageRGBA::Index(header.width),
+			ImageRGBA::Index(header.height),
+			mapping,
+			mapSize,
+			header.dataOffset
+		);
+	}
+
+	void write_cache_entry_( std::string const& aEntry, char const* aPath, std::int64_t aTime, std::uint64_t aSize, ImageRGBA const& aImage )
+	{
+		std::size_t const pathLength = std::strlen( aPath );
+		std::size_t const dataOffset = (sizeof(CacheHeader_) + pathLength + kCacheDataAlign-1) / kCacheDataAlign * kCacheDataAlign;
+
+		CacheHeader_ header{};
+		std::memcpy( header.magic, kCacheMagic, sizeof(kCacheMagic) );
+		header.version = kCacheVersion;
+		header.width = aImage.get_width();
+		header.height = aImage.get_height();
+		header.sourceTime = aTime;
+		header.sourceSize = aSize;
+		header.pathLength = std::uint32_t(pathLength);
+		header.dataOffset = std::uint32_t(dataOffset);
+
+		// Write to a temporary file first and then rename it into place. This
+		// way, other processes never observe a partially written entry.
+		char suffix[32];
+		std::snprintf( suffix, sizeof(suffix), ".%08x.tmp", unsigned(std::random_device{}()) );
+		std::string const temp = aEntry + suffix;
+
+		{
+			std::ofstream ofs( temp, std::ios::binary | std::ios::trunc );
+			if( !ofs )
+				return;
+
+			char const padding[kCacheDataAlign] = {};
+			std::size_t const pixelBytes = std::size_t(header.width) * header.height * 4;
+
+			ofs.write( reinterpret_cast<char const*>(&header), sizeof(header) );
+			ofs.write( aPath, std::streamsize(pathLength) );
+			ofs.write( padding, std::streamsize(dataOffset - sizeof(header) - pathLength) );
+			ofs.write( reinterpret_cast<char const*>(aImage.get_image_ptr()), std::streamsize(pixelBytes) );
+
+			if( !ofs )
+			{
+				ofs.close();
+				std::error_code ec;
+				std::filesystem::remove( temp, ec );
+				return;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename( temp, aEntry, ec );
+		if( ec )
+			std::filesystem::remove( temp, ec );
+	}
+
+
+#	if defined(_WIN32)
+	void* map_file_( char const* aPath, std::size_t& aSizeOut ) noexcept
+	{
+		HANDLE file = CreateFileA( aPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+		if( INVALID_HANDLE_VALUE == file )
+			return nullptr;
+
+		LARGE_INTEGER size;
+		if( !GetFileSizeEx( file, &size ) || 0 == size.QuadPart )
+		{
+			CloseHandle( file );
+			return nullptr;
+		}
+
+		HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+		CloseHandle( file );
+		if( !mapping )
+			return nullptr;
+
+		// The view keeps the mapping object alive.
+		void* view = MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+		CloseHandle( mapping );
+		if( !view )
+			return nullptr;
+
+		aSizeOut = std::size_t(size.QuadPart);
+		return view;
+	}
+	void unmap_file_( void* aMapping, std::size_t ) noexcept
+	{
+		UnmapViewOfFile( aMapping );
+	}
+#	else // !_WIN32
+	void* map_file_( char const* aPath, std::size_t& aSizeOut ) noexcept
+	{
+		int const fd = ::open( aPath, O_RDONLY );
+		if( -1 == fd )
+			return nullptr;
+
+		struct stat st;
+		if( 0 != ::fstat( fd, &st ) || st.st_size <= 0 )
+		{
+			::close( fd );
+			return nullptr;
+		}
+
+		// MAP_PRIVATE: pages are shared with the page cache (and with other
+		// processes mapping the same file) until written to.
+		std::size_t const size = std::size_t(st.st_size);
+		void* ptr = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+		::close( fd );
+
+		if( MAP_FAILED == ptr )
+			return nullptr;
+
+		aSizeOut = size;
+		return ptr;
+	}
+	void unmap_file_( void* aMapping, std::size_t aSize ) noexcept
+	{
+		::munmap( aMapping, aSize );
+	}
+#	endif // ~ _WIN32
 }
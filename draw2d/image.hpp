@@ -7,6 +7,7 @@
 // must not change the Image class interface or the declaration of blit_masked().
 
 #include <memory>
+#include <future>
 
 #include <cassert>
 #include <cstdlib>
@@ -73,6 +74,42 @@ class ImageRGBA
  */
 std::unique_ptr<ImageRGBA> load_image( char const* aPath );
 
+/** Load image from disk, through a cache of pre-decoded images
+ *
+ * Behaves like `load_image()`, but keeps a raw, already decoded and flipped,
+ * copy of the RGBA data in aCacheDir. The cache entry is keyed by the source
+ * path and the source file's modification time (and size). If a valid entry
+ * exists, it is memory mapped directly (copy-on-write) instead of decoding
+ * the source image. This skips the PNG decode/inflate entirely, and lets
+ * processes on the same machine share the pages via the OS's page cache.
+ *
+ * If the entry is missing or stale, the image is decoded with `load_image()`
+ * and a new entry is written. Problems with the cache itself (e.g., a
+ * read-only directory) are not errors; the function then simply returns the
+ * decoded image.
+ */
+std::unique_ptr<ImageRGBA> load_image_cached(
+	char const* aPath,
+	char const* aCacheDir = "_cache_"
+);
+
+/** Load image from disk in the background
+ *
+ * Starts loading the image at aPath (via `load_image_cached()`) on a separate
+ * thread and returns immediately. Several images can be requested
+ * back-to-back to have them decoded in parallel; the caller can meanwhile do
+ * other setup work (e.g., create the window and OpenGL context). Call
+ * `get()` on the returned future to obtain the image. Errors during loading
+ * are rethrown from `get()`.
+ *
+ * Note: aPath and aCacheDir must remain valid until the future is ready. They
+ * are typically string literals.
+ */
+std::future<std::unique_ptr<ImageRGBA>> load_image_async(
+	char const* aPath,
+	char const* aCacheDir = "_cache_"
+);
+
 /** Blit image ImageRGBA into the provided Surface, at position aPosition
  *
  * REMINDER: DO NOT CHANGE THE PROTOTYPE OF THIS FUNCTION (see comment at the top)
@@ -0,0 +1,207 @@
+#include "mipmap.hpp"
+
+#include <cmath>
+#include <utility>
+#include <algorithm>
+#include <vector>
+
+#include <cstdint>
+
+#include "color.hpp"
+#include "image.hpp"
+#include "surface.hpp"
+
+namespace
+{
+	// Image that owns its (new[]-allocated) pixel data.
+	struct OwnedImageRGBA_ : public ImageRGBA
+	{
+		OwnedImageRGBA_( Index, Index );
+		virtual ~OwnedImageRGBA_();
+	};
+
+	std::unique_ptr<ImageRGBA> downsample_box_( ImageRGBA const& );
+}
+
+std::vector<std::unique_ptr<ImageRGBA>> make_mip_chain( ImageRGBA const& aImage )
+{
+	std::vector<std::unique_ptr<ImageRGBA>> levels;
+
+	ImageRGBA const* previous = &aImage;
+	while( previous->get_width() > 1 || previous->get_height() > 1 )
+	{
+		levels.emplace_back( downsample_box_( *previous ) );
+		previous = levels.back().get();
+	}
+
+	return levels;
+}
+
+
+SpriteMipChain::SpriteMipChain( std::vector<SpriteRGBx>&& aLevels )
+	: mLevels( std::move( aLevels ) )
+{
+	assert( !mLevels.empty() );
+}
+
+SpriteMipChain make_sprite_mips( ImageRGBA const& aImage )
+{
+	auto const chain = make_mip_chain( aImage );
+
+	std::vector<SpriteRGBx> levels;
+	levels.reserve( chain.size() + 1 );
+
+	levels.emplace_back( make_sprite( aImage ) );
+	for( auto const& level : chain )
+		levels.emplace_back( make_sprite( *level ) );
+
+	return SpriteMipChain( std::move(levels) );
+}
+
+
+void blit_masked_scaled( Surface& aSurface, SpriteMipChain const& aMips, Vec2f aPosition, float aScale )
+{
+	auto const& base = aMips.get_level( 0 );
+
+	int const destWidth = int(float(base.get_width()) * aScale + 0.5f);
+	int const destHeight = int(float(base.get_height()) * aScale + 0.5f);
+
+	if( destWidth <= 0 || destHeight <= 0 )
+		return;
+
+	// Pick the level closest to the destination size: level L has 1/2^L the
+	// resolution of level 0.
+	float const lod = std::log2( 1.f / aScale );
+	long const nearest = std::lround( lod );
+	std::size_t const level = std::size_t(std::clamp( nearest, 0l, long(aMips.level_count()-1) ));
+
+	auto const& sprite = aMips.get_level( level );
+
+	// Same integer placement as blit_masked().
+	int const offX = static_cast<int>(aPosition.x);
+	int const offY = static_cast<int>(aPosition.y);
+
+	int const surfaceWidth = int(aSurface.get_width());
+	int const surfaceHeight = int(aSurface.get_height());
+
+	int const beginX = std::max( 0, -offX );
+	int const beginY = std::max( 0, -offY );
+	int const endX = std::min( destWidth, surfaceWidth - offX );
+	int const endY = std::min( destHeight, surfaceHeight - offY );
+
+	if( beginX >= endX || beginY >= endY )
+		return;
+
+	// Source coordinates are stepped in 16.16 fixed point. Destination pixel
+	// d samples the source at (d+0.5) * srcSize/destSize.
+	std::uint64_t const stepX = (std::uint64_t(sprite.get_width()) << 16) / std::uint64_t(destWidth);
+	std::uint64_t const stepY = (std::uint64_t(sprite.get_height()) << 16) / std::uint64_t(destHeight);
+
+	std::uint32_t const transparent = SpriteRGBx::kTransparent;
+	std::uint8_t* const surface = aSurface.get_surface_ptr();
+
+	std::uint64_t sy = std::uint64_t(beginY) * stepY + stepY/2;
+	for( int y = beginY; y < endY; ++y, sy += stepY )
+	{
+		auto const srcY = std::min( SpriteRGBx::Index(sy >> 16), sprite.get_height()-1 );
+		std::uint32_t const* src = sprite.get_row_ptr( srcY );
+
+		auto const rowIndex = aSurface.get_linear_index( Surface::Index(offX + beginX), Surface::Index(offY + y) );
+		auto* dst = reinterpret_cast<std::uint32_t*>(surface + rowIndex);
+
+		std::uint64_t sx = std::uint64_t(beginX) * stepX + stepX/2;
+		for( int x = beginX; x < endX; ++x, sx += stepX, ++dst )
+		{
+			auto const srcX = std::min( SpriteRGBx::Index(sx >> 16), sprite.get_width()-1 );
+
+			std::uint32_t const word = src[srcX];
+			std::uint32_t const keep = 0u - std::uint32_t(0 != (word & transparent));
+			*dst = (word & ~keep) | (*dst & keep);
+		}
+	}
+}
+
+namespace
+{
+	OwnedImageRGBA_::OwnedImageRGBA_( Index aWidth, Index aHeight )
+	{
+		mWidth = aWidth;
+		mHeight = aHeight;
+		mData = new std::uint8_t[std::size_t(aWidth) * aHeight * 4];
+	}
+
+	OwnedImageRGBA_::~OwnedImageRGBA_()
+	{
+		delete [] mData;
+	}
+
+
+	std::unique_ptr<ImageRGBA> downsample_box_( ImageRGBA const& aImage )
+	{
+		auto const srcWidth = aImage.get_width();
+		auto const srcHeight = aImage.get_height();
+
+		auto const width = std::max( srcWidth / 2, ImageRGBA::Index(1) );
+		auto const height = std::max( srcHeight / 2, ImageRGBA::Index(1) );
+
+		auto ret = std::make_unique<OwnedImageRGBA_>( width, height );
+		std::uint8_t* dst = ret->get_image_ptr();
+
+		// Each row is filtered into linear colors first, and then encoded to
+		// sRGB with a single batched conversion.
+		std::vector<ColorF> linear( width );
+		std::vector<ColorU8_sRGB> encoded( width );
+		std::vector<std::uint8_t> alpha( width );
+
+		for( ImageRGBA::Index y = 0; y < height; ++y )
+		{
+			// Clamp for 1-pixel wide/high sources.
+			ImageRGBA::Index const y0 = std::min( 2*y, srcHeight-1 );
+			ImageRGBA::Index const y1 = std::min( 2*y+1, srcHeight-1 );
+
+			for( ImageRGBA::Index x = 0; x < width; ++x )
+			{
+				ImageRGBA::Index const x0 = std::min( 2*x, srcWidth-1 );
+				ImageRGBA::Index const x1 = std::min( 2*x+1, srcWidth-1 );
+
+				ColorU8_sRGB_Alpha const texels[4] = {
+					aImage.get_pixel( x0, y0 ),
+					aImage.get_pixel( x1, y0 ),
+					aImage.get_pixel( x0, y1 ),
+					aImage.get_pixel( x1, y1 )
+				};
+
+				// Average in linear RGB, weighted by alpha.
+				float r = 0.f, g = 0.f, b = 0.f, wsum = 0.f;
+				unsigned asum = 0;
+				for( auto const& t : texels )
+				{
+					float const w = float(t.a);
+					r += w * linear_from_srgb( t.r );
+					g += w * linear_from_srgb( t.g );
+					b += w * linear_from_srgb( t.b );
+					wsum += w;
+					asum += t.a;
+				}
+
+				linear[x] = ColorF{ 0.f, 0.f, 0.f };
+				if( wsum > 0.f )
+					linear[x] = ColorF{ r / wsum, g / wsum, b / wsum };
+
+				alpha[x] = std::uint8_t((asum + 2) / 4);
+			}
+
+			linear_to_srgb( width, linear.data(), encoded.data() );
+
+			for( ImageRGBA::Index x = 0; x < width; ++x, dst += 4 )
+			{
+				dst[0] = encoded[x].r;
+				dst[1] = encoded[x].g;
+				dst[2] = encoded[x].b;
+				dst[3] = alpha[x];
+			}
+		}
+
+		return ret;
+	}
+}
@@ -0,0 +1,75 @@
+#ifndef MIPMAP_HPP_4E8A2D17_C3B9_4F60_A5D1_7B92E0F6C348
+#define MIPMAP_HPP_4E8A2D17_C3B9_4F60_A5D1_7B92E0F6C348
+
+#include <memory>
+#include <vector>
+
+#include <cassert>
+#include <cstdlib>
+
+#include "forward.hpp"
+#include "sprite.hpp"
+
+#include "../vmlib/vec2.hpp"
+
+/** Build a box-filtered mip chain for an image
+ *
+ * Returns levels 1 to N; level 0 is the input image itself. Each level halves
+ * the width and height of the previous one (rounding down, but never below
+ * one pixel), until the 1x1 level is reached.
+ *
+ * Each texel of level i+1 is the average of a 2x2 block of level i. Colors
+ * are averaged in linear RGB and weighted by alpha, such that transparent
+ * texels do not darken the edges of the sprite. Alpha is averaged directly.
+ */
+std::vector<std::unique_ptr<ImageRGBA>> make_mip_chain( ImageRGBA const& );
+
+/** SpriteMipChain - mip levels of a sprite, in blit-ready form
+ *
+ * Level 0 is the full resolution sprite. See make_sprite_mips().
+ */
+class SpriteMipChain final
+{
+	public:
+		explicit SpriteMipChain( std::vector<SpriteRGBx>&& );
+
+		// Move-only, like SpriteRGBx.
+		SpriteMipChain( SpriteMipChain const& ) = delete;
+		SpriteMipChain& operator= (SpriteMipChain const&) = delete;
+
+		SpriteMipChain( SpriteMipChain&& ) noexcept = default;
+		SpriteMipChain& operator= (SpriteMipChain&&) noexcept = default;
+
+	public:
+		std::size_t level_count() const noexcept { return mLevels.size(); }
+
+		SpriteRGBx const& get_level( std::size_t aLevel ) const noexcept
+		{
+			assert( aLevel < mLevels.size() );
+			return mLevels[aLevel];
+		}
+
+	private:
+		std::vector<SpriteRGBx> mLevels;
+};
+
+/** Convert an image and its mip chain (make_mip_chain()) to sprites */
+SpriteMipChain make_sprite_mips( ImageRGBA const& );
+
+/** Blit sprite scaled by aScale, at position aPosition
+ *
+ * The destination rectangle has the size of level 0 times aScale. The blit
+ * samples the mip level whose resolution is closest to the destination size
+ * (nearest neighbour within that level). Scales below 1 thus only read a
+ * fraction of the full-resolution pixels.
+ *
+ * The same alpha mask as blit_masked() applies.
+ */
+void blit_masked_scaled(
+	Surface&,
+	SpriteMipChain const&,
+	Vec2f aPosition,
+	float aScale
+);
+
+#endif // MIPMAP_HPP_4E8A2D17_C3B9_4F60_A5D1_7B92E0F6C348
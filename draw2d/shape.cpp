@@ -1,17 +1,54 @@
 #include "shape.hpp"
 
+#include <memory>
+#include <vector>
 #include <utility>
+#include <algorithm>
 
+#include <cmath>
 #include <cassert>
 #include <cstring>
 
-#include "draw.hpp"
 #include "color.hpp"
 #include "surface.hpp"
 
+#include "../vmlib/transform.hpp"
+
+namespace
+{
+	float bounding_radius_( std::size_t aCount, Vec2f const* aVerts ) noexcept;
+
+	// Largest factor by which the matrix scales any vector (its largest
+	// singular value)
+	float max_scale_( Mat22f const& ) noexcept;
+
+	// Returns true if the circle with radius aRadius around aCenter misses
+	// the surface (i.e., nothing can be drawn).
+	bool misses_surface_( Surface const&, float aRadius, Vec2f const& aCenter ) noexcept;
+
+	// Transforms all vertices into a per-thread scratch buffer that is
+	// reused between draw calls (and thus only allocates when it grows). The
+	// returned pointer is valid until the next call.
+	Vec2f const* transform_to_scratch_( std::size_t aCount, Vec2f const*, Mat22f const&, Vec2f const& );
+
+	// As above, but only the vertices aVerts[aIndices[i]], i in [0,aCount)
+	Vec2f const* transform_to_scratch_( std::size_t aCount, Vec2f const*, std::uint8_t const* aIndices, Mat22f const&, Vec2f const& );
+
+	// Rasterizes a whole (transformed) fan; see TriangleFan::draw(). Point i
+	// has the color aColors[aColorIndices[i]], or aColors[i] if
+	// aColorIndices is null.
+	void draw_fan_interp_( Surface&, std::size_t aCount, Vec2f const* aPoints, ColorF const* aColors, std::uint8_t const* aColorIndices );
+
+	// Rasterizes a whole (transformed) line strip; see LineStrip::draw().
+	// Calls aPlot( x, y ) for each pixel.
+	template< typename tPlot >
+	void rasterize_polyline_( Surface const&, std::size_t aCount, Vec2f const* aPoints, tPlot&& aPlot );
+}
+
 LineStrip::LineStrip( std::size_t aCount, Vec2f const* aVerts )
 	: mCount( aCount )
 	, mVertices( nullptr )
+	, mRadius( bounding_radius_( aCount, aVerts ) )
 {
 	assert( aVerts );
 
@@ -27,99 +64,551 @@ LineStrip::~LineStrip()
 LineStrip::LineStrip( LineStrip&& aOther ) noexcept
 	: mCount( std::exchange( aOther.mCount, 0 ) )
 	, mVertices( std::exchange( aOther.mVertices, nullptr ) )
+	, mRadius( std::exchange( aOther.mRadius, 0.f ) )
 {}
 LineStrip& LineStrip::operator= (LineStrip&& aOther)  noexcept
 {
 	std::swap( mCount, aOther.mCount );
 	std::swap( mVertices, aOther.mVertices );
+	std::swap( mRadius, aOther.mRadius );
 	return *this;
 }
 
 void LineStrip::draw( Surface& aSurface, ColorF const& aColor, Mat22f const& aRotation, Vec2f const& aTranslation ) const
 {
+	// The transformed bounding circle is contained in a circle around
+	// aTranslation, with the radius scaled by the matrix' largest scale.
+	if( misses_surface_( aSurface, mRadius * max_scale_( aRotation ), aTranslation ) )
+		return;
+
 	ColorU8_sRGB const color = linear_to_srgb( aColor );
 
-	Vec2f previous = aRotation * mVertices[0] + aTranslation;
+	Vec2f const* points = transform_to_scratch_( mCount, mVertices, aRotation, aTranslation );
+	rasterize_polyline_( aSurface, mCount, points, [&] (Surface::Index aX, Surface::Index aY) {
+		aSurface.set_pixel_srgb( aX, aY, color );
+	} );
+}
+
+
+TriangleFan::Storage::Storage( std::size_t aCount )
+	: mCount( aCount )
+	, mHeapVertices( nullptr )
+	, mHeapColors( nullptr )
+{
+	if( mCount <= kInlineCapacity )
+		return;
+
+	// One block: all positions, followed by all colors. Both types only
+	// require the alignment of float.
+	static_assert( alignof(ColorF) <= alignof(Vec2f) );
+
+	auto* block = new std::uint8_t[ mCount * (sizeof(Vec2f) + sizeof(ColorF)) ];
+	mHeapVertices = reinterpret_cast<Vec2f*>(block);
+	mHeapColors = reinterpret_cast<ColorF*>(block + mCount*sizeof(Vec2f));
+
+	std::uninitialized_default_construct_n( mHeapVertices, mCount );
+	std::uninitialized_default_construct_n( mHeapColors, mCount );
+}
+
+TriangleFan::Storage::~Storage()
+{
+	release_();
+}
 
-	for( std::size_t i = 1; i < mCount; ++i )
+TriangleFan::Storage::Storage( Storage&& aOther ) noexcept
+	: mCount( 0 )
+	, mHeapVertices( nullptr )
+	, mHeapColors( nullptr )
+{
+	take_( aOther );
+}
+TriangleFan::Storage& TriangleFan::Storage::operator= (Storage&& aOther) noexcept
+{
+	if( this != &aOther )
 	{
-		Vec2f const current = aRotation * mVertices[i] + aTranslation;
-		draw_line_solid( aSurface, previous, current, color );
-		previous = current;
+		release_();
+		take_( aOther );
+	}
+	return *this;
+}
+
+void TriangleFan::Storage::release_() noexcept
+{
+	// Vec2f and ColorF are trivially destructible; just free the block.
+	delete [] reinterpret_cast<std::uint8_t*>(mHeapVertices);
+
+	mCount = 0;
+	mHeapVertices = nullptr;
+	mHeapColors = nullptr;
+}
+void TriangleFan::Storage::take_( Storage& aOther ) noexcept
+{
+	mCount = std::exchange( aOther.mCount, 0 );
+	mHeapVertices = std::exchange( aOther.mHeapVertices, nullptr );
+	mHeapColors = std::exchange( aOther.mHeapColors, nullptr );
+
+	if( !mHeapVertices )
+	{
+		std::memcpy( mInlineVertices, aOther.mInlineVertices, sizeof(Vec2f)*mCount );
+		std::memcpy( mInlineColors, aOther.mInlineColors, sizeof(ColorF)*mCount );
 	}
 }
 
 
 TriangleFan::TriangleFan( std::size_t aCount, PosAndCol const* aVerts )
-	: mCount( aCount )
-	, mVertices( nullptr )
-	, mColors( nullptr )
+	: mStorage( aCount )
+	, mRadius( 0.f )
+	, mLodCount( 0 )
 {
-	// Note: technically unsafe if "new" fails to allocate memory
+	assert( aVerts );
 
-	mVertices = new Vec2f[mCount];
-	mColors = new ColorF[mCount];
+	Vec2f* vertices = mStorage.vertices();
+	ColorF* colors = mStorage.colors();
 
-	for( std::size_t i = 0; i < mCount; ++i )
+	for( std::size_t i = 0; i < aCount; ++i )
 	{
-		mVertices[i] = aVerts[i].pos;
-		mColors[i] = aVerts[i].col;
+		vertices[i] = aVerts[i].pos;
+		colors[i] = aVerts[i].col;
 	}
+
+	mRadius = bounding_radius_( aCount, vertices );
 }
 TriangleFan::TriangleFan( std::size_t aCount, Vec2f const* aVerts, ColorF const* aColors )
-	: mCount( aCount )
-	, mVertices( nullptr )
-	, mColors( nullptr )
+	: mStorage( aCount )
+	, mRadius( bounding_radius_( aCount, aVerts ) )
+	, mLodCount( 0 )
 {
 	assert( aVerts && aColors );
 
-	// Note: technically unsafe if "new" fails to allocate memory
-
-	mVertices = new Vec2f[mCount];
-	std::memcpy( mVertices, aVerts, sizeof(Vec2f)*mCount );
-
-	mColors = new ColorF[mCount];
-	std::memcpy( mColors, aColors, sizeof(ColorF)*mCount );
+	std::memcpy( mStorage.vertices(), aVerts, sizeof(Vec2f)*aCount );
+	std::memcpy( mStorage.colors(), aColors, sizeof(ColorF)*aCount );
 }
+TriangleFan::TriangleFan( Storage&& aStorage )
+	: mStorage( std::move(aStorage) )
+	, mRadius( bounding_radius_( mStorage.size(), mStorage.vertices() ) )
+	, mLodCount( 0 )
+{}
 
-TriangleFan::~TriangleFan()
-{
-	delete [] mColors;
-	delete [] mVertices;
-}
+TriangleFan::~TriangleFan() = default;
 
 
 TriangleFan::TriangleFan( TriangleFan&& aOther ) noexcept
-	: mCount( std::exchange( aOther.mCount, 0 ) )
-	, mVertices( std::exchange( aOther.mVertices, nullptr ) )
-	, mColors( std::exchange( aOther.mColors, nullptr ) )
-{}
+	: mStorage( std::move(aOther.mStorage) )
+	, mRadius( std::exchange( aOther.mRadius, 0.f ) )
+	, mLodCount( std::exchange( aOther.mLodCount, 0 ) )
+{
+	std::copy_n( aOther.mLods, mLodCount, mLods );
+	std::copy_n( aOther.mLodSizes, mLodCount, mLodSizes );
+	std::copy_n( &aOther.mLodIndices[0][0], mLodCount * kMaxLodVertices, &mLodIndices[0][0] );
+}
 TriangleFan& TriangleFan::operator= (TriangleFan&& aOther)  noexcept
 {
-	std::swap( mCount, aOther.mCount );
-	std::swap( mVertices, aOther.mVertices );
-	std::swap( mColors, aOther.mColors );
+	mStorage = std::move(aOther.mStorage);
+	mRadius = std::exchange( aOther.mRadius, 0.f );
+	mLodCount = std::exchange( aOther.mLodCount, 0 );
+	std::copy_n( aOther.mLods, mLodCount, mLods );
+	std::copy_n( aOther.mLodSizes, mLodCount, mLodSizes );
+	std::copy_n( &aOther.mLodIndices[0][0], mLodCount * kMaxLodVertices, &mLodIndices[0][0] );
 	return *this;
 }
 
 
+void TriangleFan::set_lods( std::size_t aCount, Lod const* aLods )
+{
+	assert( aCount <= kMaxLods );
+	assert( aLods || 0 == aCount );
+
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		// Masks can only address the first 64 rim vertices.
+		assert( mStorage.size() >= 1 && mStorage.size() <= 65 );
+		assert( mStorage.size() == 65 || 0 == (aLods[i].rimMask >> (mStorage.size()-1)) );
+		assert( 0 == i || aLods[i].maxRadius <= aLods[i-1].maxRadius );
+
+		mLods[i] = aLods[i];
+
+		// Vertex indices of the level, such that draw() can address the
+		// level's vertices directly
+		std::size_t size = 0;
+		mLodIndices[i][size++] = 0;
+
+		for( std::size_t rim = 0; rim+1 < mStorage.size(); ++rim )
+		{
+			if( aLods[i].rimMask & (std::uint64_t(1) << rim) )
+				mLodIndices[i][size++] = std::uint8_t(1+rim);
+		}
+
+		mLodSizes[i] = size;
+	}
+
+	mLodCount = aCount;
+}
+
 void TriangleFan::draw( Surface& aSurface, Mat22f const& aRotation, Vec2f const& aTranslation ) const
 {
-	Vec2f const center = aRotation * mVertices[0] + aTranslation;
-	ColorF const cencol = mColors[0];
+	draw_( aSurface, aRotation, aTranslation, nullptr );
+}
+void TriangleFan::draw( Surface& aSurface, Mat22f const& aRotation, Vec2f const& aTranslation, ColorF const& aTint ) const
+{
+	draw_( aSurface, aRotation, aTranslation, &aTint );
+}
+
+void TriangleFan::draw_( Surface& aSurface, Mat22f const& aRotation, Vec2f const& aTranslation, ColorF const* aTint ) const
+{
+	// See LineStrip::draw()
+	float const projectedRadius = mRadius * max_scale_( aRotation );
+	if( misses_surface_( aSurface, projectedRadius, aTranslation ) )
+		return;
+
+	std::size_t count = mStorage.size();
+	ColorF const* colors = mStorage.colors();
+
+	// Levels are ordered by decreasing maxRadius, so the usable ones form a
+	// prefix. Pick the coarsest of them, and address its vertices through
+	// the level's index list.
+	std::size_t usable = 0;
+	while( usable < mLodCount && projectedRadius < mLods[usable].maxRadius )
+		++usable;
+
+	std::uint8_t const* indices = nullptr;
+	if( usable > 0 )
+	{
+		count = mLodSizes[usable-1];
+		indices = mLodIndices[usable-1];
+	}
+
+	Vec2f const* const points = indices
+		? transform_to_scratch_( count, mStorage.vertices(), indices, aRotation, aTranslation )
+		: transform_to_scratch_( count, mStorage.vertices(), aRotation, aTranslation );
 
-	Vec2f previous = aRotation * mVertices[1] + aTranslation;
-	ColorF pcol = mColors[1];
-	for( std::size_t i = 2; i < mCount; ++i )
+	if( aTint )
 	{
-		Vec2f const current = aRotation * mVertices[i] + aTranslation;
-		ColorF const curcol = mColors[i];
-		draw_triangle_interp( aSurface, center, previous, current, cencol, pcol, curcol );
-		previous = current;
-		pcol = curcol;
+		thread_local std::vector<ColorF> tintedColors;
+		tintedColors.resize( count );
+
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			ColorF const& color = colors[indices ? indices[i] : i];
+			tintedColors[i] = ColorF{
+				std::min( color.r * aTint->r, 1.f ),
+				std::min( color.g * aTint->g, 1.f ),
+				std::min( color.b * aTint->b, 1.f )
+			};
+		}
+
+		// The tinted colors are already in the level's order
+		colors = tintedColors.data();
+		indices = nullptr;
 	}
 
-	Vec2f const first = aRotation * mVertices[1] + aTranslation;
-	ColorF const fcol = mColors[1];
-	draw_triangle_interp( aSurface, center, previous, first, cencol, pcol, fcol );
+	draw_fan_interp_( aSurface, count, points, colors, indices );
+}
+
+namespace
+{
+	float bounding_radius_( std::size_t aCount, Vec2f const* aVerts ) noexcept
+	{
+		float maxSquared = 0.f;
+		for( std::size_t i = 0; i < aCount; ++i )
+			maxSquared = std::max( maxSquared, dot( aVerts[i], aVerts[i] ) );
+
+		return std::sqrt( maxSquared );
+	}
+
+	float max_scale_( Mat22f const& aTransform ) noexcept
+	{
+		//   s^2 = (f + sqrt(f^2 - 4 det^2)) / 2,   f = sum of squared elements
+		float const f = aTransform._00*aTransform._00 + aTransform._01*aTransform._01
+			+ aTransform._10*aTransform._10 + aTransform._11*aTransform._11;
+		float const det = determinant( aTransform );
+		float const disc = std::max( f*f - 4.f*det*det, 0.f );
+		return std::sqrt( 0.5f * (f + std::sqrt( disc )) );
+	}
+
+	bool misses_surface_( Surface const& aSurface, float aRadius, Vec2f const& aCenter ) noexcept
+	{
+		// One pixel of slack for rounding in the rasterizers.
+		float const radius = aRadius + 1.f;
+
+		// Circle vs. rectangle [0,width] x [0,height]: distance from the
+		// center to the closest point of the rectangle.
+		float const width = float(aSurface.get_width());
+		float const height = float(aSurface.get_height());
+
+		float const dx = std::max( { -aCenter.x, 0.f, aCenter.x - width } );
+		float const dy = std::max( { -aCenter.y, 0.f, aCenter.y - height } );
+
+		return dx*dx + dy*dy > radius*radius;
+	}
+
+	Vec2f const* transform_to_scratch_( std::size_t aCount, Vec2f const* aVerts, Mat22f const& aTransform, Vec2f const& aTranslation )
+	{
+		thread_local std::vector<Vec2f> scratch;
+		if( scratch.size() < aCount )
+			scratch.resize( aCount );
+
+		transform_points( aCount, aVerts, scratch.data(), aTransform, aTranslation );
+		return scratch.data();
+	}
+	Vec2f const* transform_to_scratch_( std::size_t aCount, Vec2f const* aVerts, std::uint8_t const* aIndices, Mat22f const& aTransform, Vec2f const& aTranslation )
+	{
+		// Levels have at most kMaxLodVertices vertices. Gather them into a
+		// contiguous block first, so that the (SIMD) bulk transform applies.
+		assert( aCount <= TriangleFan::kMaxLodVertices );
+
+		Vec2f gathered[TriangleFan::kMaxLodVertices];
+		for( std::size_t i = 0; i < aCount; ++i )
+			gathered[i] = aVerts[aIndices[i]];
+
+		return transform_to_scratch_( aCount, gathered, aTransform, aTranslation );
+	}
+
+
+	void draw_fan_interp_( Surface& aSurface, std::size_t aCount, Vec2f const* aPoints, ColorF const* aColors, std::uint8_t const* aColorIndices )
+	{
+		if( aCount < 3 )
+			return;
+
+		std::size_t const rimCount = aCount - 1;
+
+		Vec2f const center = aPoints[0];
+		auto const color_ = [aColors, aColorIndices] (std::size_t aIndex) -> ColorF const& {
+			return aColors[aColorIndices ? aColorIndices[aIndex] : aIndex];
+		};
+
+		ColorF const cencol = color_( 0 );
+
+		int const maxX = int(aSurface.get_width()) - 1;
+		int const maxY = int(aSurface.get_height()) - 1;
+
+		// Spoke k runs from the center to rim vertex k. Its edge function is
+		//
+		//   S(x,y) = (x - center.x) * d.y - (y - center.y) * d.x
+		//
+		// with d = rim vertex - center. Each spoke borders two triangles,
+		// which see it with opposite signs. The spoke direction is computed
+		// once and carried over to the next triangle, and S is evaluated by
+		// the same expression in both; a pixel on a shared spoke thus gets
+		// exactly opposite values in the two triangles.
+		auto const spoke_ = [&center] (Vec2f aD, float aX, float aY) {
+			return (aX - center.x) * aD.y - (aY - center.y) * aD.x;
+		};
+
+		// Top-left rule: a pixel exactly on an edge belongs to the triangle
+		// for which the (normalized) edge function increases along +x (or
+		// along +y for horizontal edges). Shared edges and vertices are then
+		// drawn exactly once.
+		auto const owns_ = [] (float aA, float aB) {
+			return aA > 0.f || (aA == 0.f && aB > 0.f);
+		};
+
+		Vec2f da = aPoints[1] - center;
+		for( std::size_t k = 0; k < rimCount; ++k )
+		{
+			std::size_t const k1 = (k+1 == rimCount) ? 0 : k+1;
+
+			Vec2f const pa = aPoints[1+k];
+			Vec2f const pb = aPoints[1+k1];
+			Vec2f const db = pb - center;
+
+			ColorF const ca = color_( 1+k );
+			ColorF const cb = color_( 1+k1 );
+
+			// Twice the signed area. Edge functions are multiplied by its
+			// sign, such that the inside is positive for either winding.
+			float const area = db.x * da.y - db.y * da.x;
+			Vec2f const dab = pb - pa;
+
+			if( 0.f == area )
+			{
+				da = db;
+				continue;
+			}
+
+			float const sign = area > 0.f ? 1.f : -1.f;
+			float const invArea = 1.f / (sign * area);
+
+			bool const ownsRim = owns_( sign * dab.y, -sign * dab.x );
+			bool const ownsA = owns_( -sign * db.y, sign * db.x ); // opposite pa: spoke to pb
+			bool const ownsB = owns_( sign * da.y, -sign * da.x ); // opposite pb: spoke to pa
+
+			// Bounding box, clipped to the surface. Pixels are sampled at
+			// integer coordinates.
+			int const x0 = std::max( 0, int(std::ceil( std::min( { center.x, pa.x, pb.x } ) )) );
+			int const y0 = std::max( 0, int(std::ceil( std::min( { center.y, pa.y, pb.y } ) )) );
+			int const x1 = std::min( maxX, int(std::floor( std::max( { center.x, pa.x, pb.x } ) )) );
+			int const y1 = std::min( maxY, int(std::floor( std::max( { center.y, pa.y, pb.y } ) )) );
+
+			for( int y = y0; y <= y1; ++y )
+			{
+				float const fy = float(y);
+				for( int x = x0; x <= x1; ++x )
+				{
+					float const fx = float(x);
+
+					float const eRim = sign * ((fx - pa.x) * dab.y - (fy - pa.y) * dab.x);
+					float const eA = -sign * spoke_( db, fx, fy );
+					float const eB = sign * spoke_( da, fx, fy );
+
+					bool const inside = (eRim > 0.f || (eRim == 0.f && ownsRim))
+						&& (eA > 0.f || (eA == 0.f && ownsA))
+						&& (eB > 0.f || (eB == 0.f && ownsB));
+
+					if( !inside )
+						continue;
+
+					// Barycentric weights
+					float const wa = eA * invArea;
+					float const wb = eB * invArea;
+					float const wc = 1.f - wa - wb;
+
+					ColorF const color{
+						wc * cencol.r + wa * ca.r + wb * cb.r,
+						wc * cencol.g + wa * ca.g + wb * cb.g,
+						wc * cencol.b + wa * ca.b + wb * cb.b
+					};
+
+					aSurface.set_pixel_srgb( Surface::Index(x), Surface::Index(y), linear_to_srgb( color ) );
+				}
+			}
+
+			da = db;
+		}
+	}
+
+	// Cohen-Sutherland style region code of a point relative to the
+	// rectangle [0,aMaxX] x [0,aMaxY]
+	unsigned region_( Vec2f aP, float aMaxX, float aMaxY ) noexcept
+	{
+		return (aP.x < 0.f ? 1u : 0u) | (aP.x > aMaxX ? 2u : 0u)
+			| (aP.y < 0.f ? 4u : 0u) | (aP.y > aMaxY ? 8u : 0u);
+	}
+
+	// Liang-Barsky: the part of aA + t (aB - aA) with t in [aT0, aT1] that is
+	// inside the rectangle. Returns false if the segment misses it.
+	bool clip_segment_( Vec2f aA, Vec2f aB, float aMaxX, float aMaxY, float& aT0, float& aT1 ) noexcept
+	{
+		Vec2f const d = aB - aA;
+
+		float const p[4] = { -d.x, d.x, -d.y, d.y };
+		float const q[4] = { aA.x, aMaxX - aA.x, aA.y, aMaxY - aA.y };
+
+		aT0 = 0.f;
+		aT1 = 1.f;
+		for( int i = 0; i < 4; ++i )
+		{
+			if( 0.f == p[i] )
+			{
+				if( q[i] < 0.f )
+					return false;
+				continue;
+			}
+
+			float const r = q[i] / p[i];
+			if( p[i] < 0.f )
+			{
+				if( r > aT1 ) return false;
+				aT0 = std::max( aT0, r );
+			}
+			else
+			{
+				if( r < aT0 ) return false;
+				aT1 = std::min( aT1, r );
+			}
+		}
+
+		return true;
+	}
+
+	template< typename tPlot >
+	void rasterize_polyline_( Surface const& aSurface, std::size_t aCount, Vec2f const* aPoints, tPlot&& aPlot )
+	{
+		if( aCount < 2 )
+			return;
+
+		int const maxX = int(aSurface.get_width()) - 1;
+		int const maxY = int(aSurface.get_height()) - 1;
+
+		float const fmaxX = float(maxX);
+		float const fmaxY = float(maxY);
+
+		auto const to_pixel_ = [] (float aValue, int aMax) {
+			return std::clamp( int(std::floor( aValue + 0.5f )), 0, aMax );
+		};
+
+		// Each vertex is classified once; the code is shared by the two
+		// segments that meet at it.
+		unsigned prevRegion = region_( aPoints[0], fmaxX, fmaxY );
+
+		// Whether the previous segment's last pixel was the (unclipped)
+		// vertex aPoints[i-1]. If so, the joint has already been plotted.
+		bool jointPlotted = false;
+
+		for( std::size_t i = 1; i < aCount; ++i )
+		{
+			Vec2f const a = aPoints[i-1];
+			Vec2f const b = aPoints[i];
+
+			unsigned const region = region_( b, fmaxX, fmaxY );
+			unsigned const segRegionA = prevRegion;
+			prevRegion = region;
+
+			// Trivially outside: both ends beyond the same border
+			if( segRegionA & region )
+			{
+				jointPlotted = false;
+				continue;
+			}
+
+			float t0 = 0.f, t1 = 1.f;
+			if( (segRegionA | region) && !clip_segment_( a, b, fmaxX, fmaxY, t0, t1 ) )
+			{
+				jointPlotted = false;
+				continue;
+			}
+
+			Vec2f const d = b - a;
+			Vec2f const ca = 0.f == t0 ? a : a + t0 * d;
+			Vec2f const cb = 1.f == t1 ? b : a + t1 * d;
+
+			int x = to_pixel_( ca.x, maxX );
+			int y = to_pixel_( ca.y, maxY );
+			int const x1 = to_pixel_( cb.x, maxX );
+			int const y1 = to_pixel_( cb.y, maxY );
+
+			// Bresenham. Integer endpoints make the joint pixel of two
+			// consecutive segments identical, so it can be skipped.
+			int const dx = std::abs( x1 - x ), sx = x < x1 ? 1 : -1;
+			int const dy = -std::abs( y1 - y ), sy = y < y1 ? 1 : -1;
+			int err = dx + dy;
+
+			bool skip = jointPlotted && 0.f == t0;
+			while( true )
+			{
+				if( !skip )
+					aPlot( Surface::Index(x), Surface::Index(y) );
+				skip = false;
+
+				if( x == x1 && y == y1 )
+					break;
+
+				int const e2 = 2*err;
+				if( e2 >= dy ) { err += dy; x += sx; }
+				if( e2 <= dx ) { err += dx; y += sy; }
+			}
+
+			jointPlotted = (1.f == t1);
+		}
+	}
+}
+
+namespace detail
+{
+	void count_polyline_plots( Surface const& aSurface, std::size_t aCount, Vec2f const* aPoints, std::uint32_t* aCounts )
+	{
+		auto const width = aSurface.get_width();
+		rasterize_polyline_( aSurface, aCount, aPoints, [&] (Surface::Index aX, Surface::Index aY) {
+			++aCounts[std::size_t(aY) * width + aX];
+		} );
+	}
 }
@@ -6,6 +6,7 @@
 // For CW1, the shape.hpp file must remain exactly as it is. In particular, you
 // must not change the LineStrip or TriangleFan class interfaces.
 
+#include <cstdint>
 #include <cstdlib>
 
 #include "forward.hpp"
@@ -56,15 +57,29 @@ class LineStrip final
 		 *
 		 * finalVertex = vertexIn * matrix + vector
 		 *
-		 * LineStrip::draw() uses draw_line_solid() internally.
+		 * LineStrip::draw() rasterizes the whole strip in one pass. Each
+		 * vertex is classified against the surface once, segments are
+		 * clipped to the same rectangle as in draw_line_solid(), and each
+		 * joint pixel is plotted exactly once. Strips that lie entirely
+		 * outside of the surface are rejected up front (see
+		 * bounding_radius()).
 		 */
 		void draw( Surface&, ColorF const&, Mat22f const&, Vec2f const& ) const;
 
 		std::size_t vertex_count() const noexcept { return mCount; }
+		Vec2f const* vertices() const noexcept { return mVertices; }
+
+		/* Radius of a circle around the local origin that contains all
+		 * vertices. Computed at construction. draw() transforms this circle
+		 * (conservatively) and skips the strip if the circle misses the
+		 * surface.
+		 */
+		float bounding_radius() const noexcept { return mRadius; }
 
 	private:
 		std::size_t mCount;
 		Vec2f* mVertices;
+		float mRadius;
 };
 
 /** Triangle fan
@@ -93,10 +108,79 @@ class TriangleFan final
 			ColorF col;
 		};
 
+		/* Vertex data of a fan
+		 *
+		 * Positions and colors (SoA) share a single block of memory. Fans with
+		 * up to kInlineCapacity vertices are stored inline, without any heap
+		 * allocation; larger fans use one allocation for both arrays.
+		 *
+		 * Code that generates fans can allocate a Storage, fill in vertices()
+		 * and colors() directly, and then hand it to TriangleFan( Storage&& ),
+		 * avoiding any intermediate copies.
+		 */
+		class Storage final
+		{
+			public:
+				static constexpr std::size_t kInlineCapacity = 32;
+
+			public:
+				explicit Storage( std::size_t aCount = 0 );
+				~Storage();
+
+				Storage( Storage const& ) = delete;
+				Storage& operator= (Storage const&) = delete;
+
+				// Moving inline storage copies the vertex data.
+				Storage( Storage&& ) noexcept;
+				Storage& operator= (Storage&&) noexcept;
+
+			public:
+				std::size_t size() const noexcept { return mCount; }
+
+				Vec2f* vertices() noexcept { return mHeapVertices ? mHeapVertices : mInlineVertices; }
+				Vec2f const* vertices() const noexcept { return mHeapVertices ? mHeapVertices : mInlineVertices; }
+
+				ColorF* colors() noexcept { return mHeapColors ? mHeapColors : mInlineColors; }
+				ColorF const* colors() const noexcept { return mHeapColors ? mHeapColors : mInlineColors; }
+
+			private:
+				void release_() noexcept;
+				void take_( Storage& ) noexcept;
+
+			private:
+				std::size_t mCount;
+
+				// Point into a single heap block for large fans (null otherwise)
+				Vec2f* mHeapVertices;
+				ColorF* mHeapColors;
+
+				Vec2f mInlineVertices[kInlineCapacity];
+				ColorF mInlineColors[kInlineCapacity];
+		};
+
+		/* Level of detail: a reduced version of the fan
+		 *
+		 * Uses only the rim vertices selected by rimMask (bit i selects rim
+		 * vertex i, i.e., vertex i+1; the center is always used). draw()
+		 * may use the level when the fan's projected bounding radius is
+		 * below maxRadius pixels. See set_lods().
+		 */
+		struct Lod
+		{
+			std::uint64_t rimMask;
+			float maxRadius;
+		};
+
+		static constexpr std::size_t kMaxLods = 3;
+		static constexpr std::size_t kMaxLodVertices = 65; // Center and 64 rim vertices
+
 	public:
 		TriangleFan( std::size_t aCount, PosAndCol const* );
 		TriangleFan( std::size_t aCount, Vec2f const*, ColorF const* );
 
+		// Take ownership of prepared vertex data
+		explicit TriangleFan( Storage&& );
+
 		// See LineStrip above.
 		template< std::size_t tCount >
 		TriangleFan( PosAndCol const (&aArray)[tCount] )
@@ -119,16 +203,66 @@ class TriangleFan final
 		 *
 		 * finalVertex = vertexIn * matrix + vector
 		 *
-		 * TriangleFan::draw() uses draw_triangle_interp() internally.  It uses
-		 * the (linear) per-vertex colors assigned at construction time.
+		 * TriangleFan::draw() rasterizes the whole fan at once, with the
+		 * same sampling and color interpolation as draw_triangle_interp().
+		 * It uses the (linear) per-vertex colors assigned at construction
+		 * time. The edge equations of the spokes are set up once and shared
+		 * by the two triangles on either side, and pixels on shared edges
+		 * are drawn exactly once (top-left rule). Like LineStrip::draw(),
+		 * fans whose bounding circle misses the surface are rejected without
+		 * any per-triangle work. Small fans are drawn with a reduced level
+		 * of detail, if the fan has any (see set_lods()).
 		 */
 		void draw( Surface&, Mat22f const&, Vec2f const& ) const;
 
+		/* Draw the triangle fan with its vertex colors multiplied by aTint
+		 *
+		 * Lets several objects share one fan, each with its own color.
+		 * Tinted colors are clamped to 1.
+		 */
+		void draw( Surface&, Mat22f const&, Vec2f const&, ColorF const& aTint ) const;
+
+		// Vertex 0 is the center; see Storage.
+		std::size_t vertex_count() const noexcept { return mStorage.size(); }
+		Vec2f const* vertices() const noexcept { return mStorage.vertices(); }
+
+		// See LineStrip::bounding_radius()
+		float bounding_radius() const noexcept { return mRadius; }
+
+		/* Set the fan's levels of detail (at most kMaxLods)
+		 *
+		 * Levels must be ordered from finest to coarsest, i.e., by
+		 * decreasing maxRadius. draw() picks the coarsest level whose
+		 * maxRadius is above the fan's projected bounding radius, and the
+		 * full fan if there is none. The masks can only address the first 64
+		 * rim vertices.
+		 */
+		void set_lods( std::size_t aCount, Lod const* );
+
+		std::size_t lod_count() const noexcept { return mLodCount; }
+		Lod const& get_lod( std::size_t aLevel ) const noexcept { return mLods[aLevel]; }
 
 	private:
-		std::size_t mCount;
-		Vec2f* mVertices;
-		ColorF* mColors;
+		void draw_( Surface&, Mat22f const&, Vec2f const&, ColorF const* ) const;
+
+	private:
+		Storage mStorage;
+		float mRadius;
+
+		std::size_t mLodCount;
+		Lod mLods[kMaxLods];
+
+		// Vertex indices of each level (center first); see set_lods()
+		std::size_t mLodSizes[kMaxLods];
+		std::uint8_t mLodIndices[kMaxLods][kMaxLodVertices];
 };
 
+namespace detail
+{
+	// Rasterizes the (already transformed) points like LineStrip::draw(), but
+	// increments aCounts[y*width + x] for each plotted pixel instead of
+	// writing it. Pixels that are plotted more than once thus show up.
+	void count_polyline_plots( Surface const&, std::size_t aCount, Vec2f const* aPoints, std::uint32_t* aCounts );
+}
+
 #endif // SHAPE_HPP_4AC47446_8CA0_4AFF_AD91_D6B54EFEF21A
@@ -0,0 +1,166 @@
+#include "sprite.hpp"
+
+#include <utility>
+#include <algorithm>
+
+#include <cstring>
+
+#include "image.hpp"
+#include "surface.hpp"
+
+namespace
+{
+	// Pack a color into a 32-bit word with the same byte layout as the
+	// Surface's RGBx pixels. Going through memcpy() keeps this independent of
+	// the host's endianness (and compiles to a plain move).
+	std::uint32_t pack_rgbx_( std::uint8_t aR, std::uint8_t aG, std::uint8_t aB, std::uint8_t aX ) noexcept
+	{
+		std::uint8_t const bytes[4] = { aR, aG, aB, aX };
+
+		std::uint32_t word;
+		std::memcpy( &word, bytes, sizeof(word) );
+		return word;
+	}
+}
+
+std::uint32_t const SpriteRGBx::kTransparent = pack_rgbx_( 0, 0, 0, 0xff );
+
+
+SpriteRGBx::SpriteRGBx( Index aWidth, Index aHeight )
+	: mWidth( aWidth )
+	, mHeight( aHeight )
+	, mPixels( std::make_unique<std::uint32_t[]>( std::size_t(aWidth) * aHeight ) )
+{}
+
+SpriteRGBx::SpriteRGBx( SpriteRGBx&& aOther ) noexcept
+	: mWidth( std::exchange( aOther.mWidth, 0 ) )
+	, mHeight( std::exchange( aOther.mHeight, 0 ) )
+	, mPixels( std::move( aOther.mPixels ) )
+{}
+SpriteRGBx& SpriteRGBx::operator= (SpriteRGBx&& aOther) noexcept
+{
+	std::swap( mWidth, aOther.mWidth );
+	std::swap( mHeight, aOther.mHeight );
+	std::swap( mPixels, aOther.mPixels );
+	return *this;
+}
+
+
+SpriteRGBx make_sprite( ImageRGBA const& aImage )
+{
+	auto const width = aImage.get_width();
+	auto const height = aImage.get_height();
+
+	SpriteRGBx sprite( width, height );
+
+	// ImageRGBA rows are already in the Surface's (bottom-up) order, since
+	// load_image() asks stb_image.h to flip on load. Row y maps to row y.
+	std::uint8_t const* src = aImage.get_image_ptr();
+	for( SpriteRGBx::Index y = 0; y < height; ++y )
+	{
+		std::uint32_t* dst = sprite.get_row_ptr( y );
+		for( SpriteRGBx::Index x = 0; x < width; ++x, src += 4 )
+		{
+			if( src[3] >= SpriteRGBx::kAlphaThreshold )
+				dst[x] = pack_rgbx_( src[0], src[1], src[2], 0 );
+			else
+				dst[x] = SpriteRGBx::kTransparent;
+		}
+	}
+
+	// Give masked-out pixels the color of an opaque neighbour (if any). The
+	// masked blits never write these, but filtered sampling blends them with
+	// their opaque neighbours.
+	std::uint32_t const transparent = SpriteRGBx::kTransparent;
+	for( SpriteRGBx::Index y = 0; y < height; ++y )
+	{
+		std::uint32_t* row = sprite.get_row_ptr( y );
+		for( SpriteRGBx::Index x = 0; x < width; ++x )
+		{
+			if( !(row[x] & transparent) )
+				continue;
+
+			for( int dy = -1; dy <= 1 && (row[x] == transparent); ++dy )
+			{
+				SpriteRGBx::Index const ny = y + dy;
+				if( ny >= height ) // also catches y + dy < 0 (wraps around)
+					continue;
+
+				std::uint32_t const* nrow = sprite.get_row_ptr( ny );
+				for( int dx = -1; dx <= 1; ++dx )
+				{
+					SpriteRGBx::Index const nx = x + dx;
+					if( nx >= width || (nrow[nx] & transparent) )
+						continue;
+
+					row[x] = nrow[nx] | transparent;
+					break;
+				}
+			}
+		}
+	}
+
+	return sprite;
+}
+
+void blit_masked( Surface& aSurface, SpriteRGBx const& aSprite, Vec2f aPosition )
+{
+	SpriteRect const whole{ 0, 0, aSprite.get_width(), aSprite.get_height() };
+
+	// Same integer placement as blit_masked() for ImageRGBA.
+	detail::blit_masked_rect( aSurface, aSprite, whole, static_cast<int>(aPosition.x), static_cast<int>(aPosition.y) );
+}
+
+void blit_masked( Surface& aSurface, SpriteRGBx const& aSprite, SpriteRect const& aSource, Vec2f aPosition )
+{
+	detail::blit_masked_rect( aSurface, aSprite, aSource, static_cast<int>(aPosition.x), static_cast<int>(aPosition.y) );
+}
+
+namespace detail
+{
+	void blit_masked_rect( Surface& aSurface, SpriteRGBx const& aSprite, SpriteRect const& aSource, int aX, int aY )
+	{
+		assert( aSource.x + aSource.width <= aSprite.get_width() );
+		assert( aSource.y + aSource.height <= aSprite.get_height() );
+
+		int const rectWidth = int(aSource.width);
+		int const rectHeight = int(aSource.height);
+		int const surfaceWidth = int(aSurface.get_width());
+		int const surfaceHeight = int(aSurface.get_height());
+
+		// Clip the source rectangle against the surface once.
+		int const beginX = std::max( 0, -aX );
+		int const beginY = std::max( 0, -aY );
+		int const endX = std::min( rectWidth, surfaceWidth - aX );
+		int const endY = std::min( rectHeight, surfaceHeight - aY );
+
+		if( beginX >= endX || beginY >= endY )
+			return;
+
+		std::uint32_t const transparent = SpriteRGBx::kTransparent;
+		std::size_t const count = std::size_t(endX - beginX);
+
+		std::uint8_t* const surface = aSurface.get_surface_ptr();
+
+		for( int y = beginY; y < endY; ++y )
+		{
+			std::uint32_t const* src = aSprite.get_row_ptr( SpriteRGBx::Index(aSource.y + y) ) + aSource.x + beginX;
+
+			// The surface stores RGBx8 pixels, i.e., one 32-bit word per
+			// pixel. The buffer comes from new std::uint8_t[], which is
+			// suitably aligned for 32-bit access.
+			auto const rowIndex = aSurface.get_linear_index( Surface::Index(aX + beginX), Surface::Index(aY + y) );
+			auto* dst = reinterpret_cast<std::uint32_t*>(surface + rowIndex);
+
+			// Masked copy: keep the destination where the sprite is
+			// transparent. This is written without branches so that the
+			// compiler can turn it into vector blends.
+			for( std::size_t x = 0; x < count; ++x )
+			{
+				std::uint32_t const word = src[x];
+				std::uint32_t const keep = 0u - std::uint32_t(0 != (word & transparent));
+				dst[x] = (word & ~keep) | (dst[x] & keep);
+			}
+		}
+	}
+}
@@ -0,0 +1,123 @@
+#ifndef SPRITE_HPP_6B0F1C2E_58A4_4D0B_9E37_2C1D7A9F4E63
+#define SPRITE_HPP_6B0F1C2E_58A4_4D0B_9E37_2C1D7A9F4E63
+
+#include <memory>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+#include "forward.hpp"
+#include "color.hpp"
+
+#include "../vmlib/vec2.hpp"
+
+/** SpriteRGBx - a blit-ready copy of an ImageRGBA
+ *
+ * ImageRGBA stores whatever stb_image.h hands us (RGBA bytes). Blitting from
+ * it means repacking every pixel through get_pixel() into a ColorU8_sRGB and
+ * then through set_pixel_srgb() back into the Surface's RGBx layout, with an
+ * alpha test in between.
+ *
+ * SpriteRGBx does that work once, at load time. Each pixel is stored as a
+ * single 32-bit word in exactly the byte order that the Surface uses (RGBx).
+ * The alpha test is precomputed: pixels that would be discarded by the mask
+ * have their padding byte set (see kTransparent below). Opaque pixels have a
+ * zero padding byte, just like the Surface. The color channels of masked-out
+ * pixels next to opaque ones hold the color of such a neighbour, so that
+ * filtered sampling (see transform_blit.hpp) does not bleed black into the
+ * sprite's edges. Rows are stored in the same (bottom-up) order as the
+ * Surface, so no flip is needed when blitting.
+ *
+ * With this, the inner loop of the blit becomes a masked 32-bit copy.
+ */
+class SpriteRGBx final
+{
+	public:
+		using Index = std::uint32_t; // See discussion in surface.hpp
+
+	public:
+		SpriteRGBx( Index aWidth, Index aHeight );
+
+		// Move-only, like Surface.
+		SpriteRGBx( SpriteRGBx const& ) = delete;
+		SpriteRGBx& operator= (SpriteRGBx const&) = delete;
+
+		SpriteRGBx( SpriteRGBx&& ) noexcept;
+		SpriteRGBx& operator= (SpriteRGBx&&) noexcept;
+
+	public:
+		Index get_width() const noexcept;
+		Index get_height() const noexcept;
+
+		// Pointer to the first pixel of row aY. Rows are tightly packed.
+		std::uint32_t* get_row_ptr( Index aY ) noexcept;
+		std::uint32_t const* get_row_ptr( Index aY ) const noexcept;
+
+	public:
+		/* Word value used for pixels that fail the alpha test. Only the
+		 * padding byte is set, so `word & kTransparent` is non-zero exactly
+		 * for masked-out pixels (whatever their color channels hold). The
+		 * value is computed from the Surface's byte layout rather than
+		 * assuming a particular endianness.
+		 */
+		static std::uint32_t const kTransparent;
+
+		// Pixels with an alpha value below this are discarded (same threshold
+		// as blit_masked()).
+		static constexpr std::uint8_t kAlphaThreshold = 128;
+
+	private:
+		Index mWidth, mHeight;
+		std::unique_ptr<std::uint32_t[]> mPixels;
+};
+
+/** Sub-rectangle of a SpriteRGBx
+ *
+ * (x, y) is the pixel that ends up at the blit position. Coordinates use the
+ * same (bottom-up) row order as the sprite and the Surface.
+ */
+struct SpriteRect
+{
+	SpriteRGBx::Index x, y;
+	SpriteRGBx::Index width, height;
+};
+
+/** Convert an ImageRGBA into a SpriteRGBx
+ *
+ * Performs the alpha test and the RGBA to RGBx repacking once.
+ */
+SpriteRGBx make_sprite( ImageRGBA const& );
+
+/** Blit sprite into the provided Surface, at position aPosition
+ *
+ * Produces the same result as blit_masked() on the ImageRGBA that the sprite
+ * was made from. The destination rectangle is clipped to the surface once,
+ * up front, instead of testing every pixel.
+ */
+void blit_masked(
+	Surface&,
+	SpriteRGBx const&,
+	Vec2f aPosition
+);
+
+/** Blit the sub-rectangle aSource of the sprite, at position aPosition
+ *
+ * Used, e.g., for sprite sheets and atlases (see atlas.hpp).
+ */
+void blit_masked(
+	Surface&,
+	SpriteRGBx const&,
+	SpriteRect const& aSource,
+	Vec2f aPosition
+);
+
+namespace detail
+{
+	// Blit with an integer destination; this is what the blit_masked()
+	// overloads reduce to after converting the position.
+	void blit_masked_rect( Surface&, SpriteRGBx const&, SpriteRect const&, int aX, int aY );
+}
+
+#include "sprite.inl"
+#endif // SPRITE_HPP_6B0F1C2E_58A4_4D0B_9E37_2C1D7A9F4E63
@@ -0,0 +1,23 @@
+inline
+auto SpriteRGBx::get_width() const noexcept -> Index
+{
+	return mWidth;
+}
+inline
+auto SpriteRGBx::get_height() const noexcept -> Index
+{
+	return mHeight;
+}
+
+inline
+std::uint32_t* SpriteRGBx::get_row_ptr( Index aY ) noexcept
+{
+	assert( aY < mHeight );
+	return mPixels.get() + std::size_t(aY) * mWidth;
+}
+inline
+std::uint32_t const* SpriteRGBx::get_row_ptr( Index aY ) const noexcept
+{
+	assert( aY < mHeight );
+	return mPixels.get() + std::size_t(aY) * mWidth;
+}
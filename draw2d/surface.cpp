@@ -54,4 +54,7 @@ std::uint8_t const* Surface::get_surface_ptr() const noexcept
 {
 	return mSurface;
 }
-
+std::uint8_t* Surface::get_surface_ptr() noexcept
+{
+	return mSurface;
+}
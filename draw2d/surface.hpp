@@ -59,6 +59,12 @@ class Surface final
 		// when implementing your drawing functions.
 		std::uint8_t const* get_surface_ptr() const noexcept;
 
+		// Writable access to the surface image data. This is reserved for
+		// the bulk copy routines (e.g., the sprite blits in sprite.cpp) that
+		// write whole 32-bit RGBx words at a time. Single pixels should still
+		// go through set_pixel_srgb().
+		std::uint8_t* get_surface_ptr() noexcept;
+
 		// Return surfac width
 		Index get_width() const noexcept;
 
@@ -0,0 +1,311 @@
+#include "transform_blit.hpp"
+
+#include <limits>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdint>
+
+#include "image.hpp"
+#include "sprite.hpp"
+#include "surface.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define DRAW2D_TRANSFORM_BLIT_SSE2 1
+#	include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Fixed point format for texture coordinates: 16.16
+	constexpr int kFixedShift = 16;
+	constexpr float kFixedOne = float(1 << kFixedShift);
+
+	/* Sets up the inverse mapping and calls aRow once for each surface row
+	 * that (potentially) overlaps the transformed image:
+	 *
+	 *   aRow( y, beginX, endX, u, v, du, dv )
+	 *
+	 * where u and v are the 16.16 fixed-point texture coordinates of pixel
+	 * (beginX, y), and du and dv are the per-pixel increments. The span
+	 * [beginX, endX) is narrowed to where the coordinates are inside the image
+	 * (with a pixel of slack for rounding), so aRow must still bounds-check
+	 * each texel.
+	 */
+	template< typename tRowFunc >
+	void for_each_span_( Surface const&, std::uint32_t aWidth, std::uint32_t aHeight, Mat22f const&, Vec2f, tRowFunc&& aRow );
+
+	// Interval of x for which aStart + aStep*x lies in [0, aLimit).
+	void solve_span_( float aStart, float aStep, float aLimit, float& aLo, float& aHi ) noexcept;
+
+	void blit_sprite_nearest_( Surface&, SpriteRGBx const&, Mat22f const&, Vec2f );
+	void blit_sprite_bilinear_( Surface&, SpriteRGBx const&, Mat22f const&, Vec2f );
+}
+
+void blit_transformed( Surface& aSurface, ImageRGBA const& aImage, Mat22f const& aTransform, Vec2f aTranslation )
+{
+	auto const width = aImage.get_width();
+	auto const height = aImage.get_height();
+
+	for_each_span_( aSurface, width, height, aTransform, aTranslation, [&] (int aY, int aBeginX, int aEndX, std::int32_t aU, std::int32_t aV, std::int32_t aDU, std::int32_t aDV) {
+		for( int x = aBeginX; x < aEndX; ++x, aU += aDU, aV += aDV )
+		{
+			auto const u = std::uint32_t(aU >> kFixedShift);
+			auto const v = std::uint32_t(aV >> kFixedShift);
+
+			if( u >= width || v >= height )
+				continue;
+
+			ColorU8_sRGB_Alpha const pixel = aImage.get_pixel( u, v );
+			if( pixel.a >= 128 )
+				aSurface.set_pixel_srgb( Surface::Index(x), Surface::Index(aY), { pixel.r, pixel.g, pixel.b } );
+		}
+	} );
+}
+
+void blit_transformed( Surface& aSurface, SpriteRGBx const& aSprite, Mat22f const& aTransform, Vec2f aTranslation, ESampleMode aMode )
+{
+	switch( aMode )
+	{
+		case ESampleMode::nearest:
+			blit_sprite_nearest_( aSurface, aSprite, aTransform, aTranslation );
+			break;
+		case ESampleMode::bilinear:
+			blit_sprite_bilinear_( aSurface, aSprite, aTransform, aTranslation );
+			break;
+	}
+}
+
+namespace
+{
+	void blit_sprite_nearest_( Surface& aSurface, SpriteRGBx const& aSprite, Mat22f const& aTransform, Vec2f aTranslation )
+	{
+		auto const width = aSprite.get_width();
+		auto const height = aSprite.get_height();
+
+		std::uint32_t const transparent = SpriteRGBx::kTransparent;
+		std::uint8_t* const surface = aSurface.get_surface_ptr();
+
+		for_each_span_( aSurface, width, height, aTransform, aTranslation, [&] (int aY, int aBeginX, int aEndX, std::int32_t aU, std::int32_t aV, std::int32_t aDU, std::int32_t aDV) {
+			auto const rowIndex = aSurface.get_linear_index( Surface::Index(aBeginX), Surface::Index(aY) );
+			auto* dst = reinterpret_cast<std::uint32_t*>(surface + rowIndex);
+
+			for( int x = aBeginX; x < aEndX; ++x, aU += aDU, aV += aDV, ++dst )
+			{
+				auto const u = std::uint32_t(aU >> kFixedShift);
+				auto const v = std::uint32_t(aV >> kFixedShift);
+
+				if( u >= width || v >= height )
+					continue;
+
+				std::uint32_t const word = aSprite.get_row_ptr( v )[u];
+				if( !(word & transparent) )
+					*dst = word;
+			}
+		} );
+	}
+
+	void blit_sprite_bilinear_( Surface& aSurface, SpriteRGBx const& aSprite, Mat22f const& aTransform, Vec2f aTranslation )
+	{
+		auto const width = aSprite.get_width();
+		auto const height = aSprite.get_height();
+
+		std::uint32_t const transparent = SpriteRGBx::kTransparent;
+		std::uint8_t* const surface = aSurface.get_surface_ptr();
+
+		// The filtered padding byte is 0 for fully opaque and 255 for fully
+		// masked-out footprints. Draw if it is below 128.
+		std::uint32_t const halfMasked = transparent & 0x80808080u;
+
+		for_each_span_( aSurface, width, height, aTransform, aTranslation, [&] (int aY, int aBeginX, int aEndX, std::int32_t aU, std::int32_t aV, std::int32_t aDU, std::int32_t aDV) {
+			auto const rowIndex = aSurface.get_linear_index( Surface::Index(aBeginX), Surface::Index(aY) );
+			auto* dst = reinterpret_cast<std::uint32_t*>(surface + rowIndex);
+
+			for( int x = aBeginX; x < aEndX; ++x, aU += aDU, aV += aDV, ++dst )
+			{
+				// Same coverage test as nearest sampling.
+				auto const u = std::uint32_t(aU >> kFixedShift);
+				auto const v = std::uint32_t(aV >> kFixedShift);
+
+				if( u >= width || v >= height )
+					continue;
+
+				// Texel centers are at i+0.5; shift by half a texel to get
+				// the top-left texel of the 2x2 footprint, and clamp the
+				// footprint to the sprite's edges.
+				std::int32_t const su = aU - (1 << (kFixedShift-1));
+				std::int32_t const sv = aV - (1 << (kFixedShift-1));
+
+				auto const fx = std::uint32_t(su >> (kFixedShift-8)) & 0xff;
+				auto const fy = std::uint32_t(sv >> (kFixedShift-8)) & 0xff;
+
+				std::int32_t const iu = su >> kFixedShift;
+				std::int32_t const iv = sv >> kFixedShift;
+
+				auto const u0 = std::uint32_t(std::max( iu, 0 ));
+				auto const v0 = std::uint32_t(std::max( iv, 0 ));
+				auto const u1 = std::min( std::uint32_t(iu+1), width-1 );
+				auto const v1 = std::min( std::uint32_t(iv+1), height-1 );
+
+				std::uint32_t const* row0 = aSprite.get_row_ptr( v0 );
+				std::uint32_t const* row1 = aSprite.get_row_ptr( v1 );
+
+				std::uint32_t const word = detail::bilerp( row0[u0], row0[u1], row1[u0], row1[u1], fx, fy );
+				if( (word & transparent) < halfMasked )
+					*dst = word & ~transparent;
+			}
+		} );
+	}
+
+	template< typename tRowFunc >
+	void for_each_span_( Surface const& aSurface, std::uint32_t aWidth, std::uint32_t aHeight, Mat22f const& aTransform, Vec2f aTranslation, tRowFunc&& aRow )
+	{
+		if( 0 == aWidth || 0 == aHeight )
+			return;
+
+		float const det = determinant( aTransform );
+		if( !(std::abs( det ) > std::numeric_limits<float>::min()) )
+			return;
+
+		Mat22f const inv = inverse( aTransform );
+
+		float const halfW = 0.5f * float(aWidth);
+		float const halfH = 0.5f * float(aHeight);
+
+		// Rows covered by the transformed image (bounding box of corners).
+		float minY = std::numeric_limits<float>::max();
+		float maxY = std::numeric_limits<float>::lowest();
+		for( Vec2f const corner : { Vec2f{ -halfW, -halfH }, Vec2f{ halfW, -halfH }, Vec2f{ -halfW, halfH }, Vec2f{ halfW, halfH } } )
+		{
+			float const y = (aTransform * corner + aTranslation).y;
+			minY = std::min( minY, y );
+			maxY = std::max( maxY, y );
+		}
+
+		int const surfaceWidth = int(aSurface.get_width());
+		int const surfaceHeight = int(aSurface.get_height());
+
+		int const beginY = int(std::clamp( std::floor( minY ), 0.f, float(surfaceHeight) ));
+		int const endY = int(std::clamp( std::ceil( maxY ) + 1.f, 0.f, float(surfaceHeight) ));
+
+		// Texture coordinates of the center of pixel (x,y):
+		//   u(x,y) = inv._00 * (x + 0.5 - t.x) + inv._01 * (y + 0.5 - t.y) + halfW
+		//   v(x,y) = inv._10 * (x + 0.5 - t.x) + inv._11 * (y + 0.5 - t.y) + halfH
+		float const du = inv._00;
+		float const dv = inv._10;
+
+		// Texture coordinates stay within about one step of the image, so
+		// they fit in 16.16 as long as the image and the per-pixel steps are
+		// below 2^15 texels. (Anything larger is not a sensible sprite.)
+		float const maxCoord = float(std::max( aWidth, aHeight )) + std::max( std::abs( du ), std::abs( dv ) );
+		if( !(maxCoord < 32767.f) )
+			return;
+
+		auto const fixedDU = std::int32_t(std::lround( du * kFixedOne ));
+		auto const fixedDV = std::int32_t(std::lround( dv * kFixedOne ));
+
+		float const cx = 0.5f - aTranslation.x;
+		for( int y = beginY; y < endY; ++y )
+		{
+			float const cy = float(y) + 0.5f - aTranslation.y;
+
+			float const u0 = inv._00 * cx + inv._01 * cy + halfW;
+			float const v0 = inv._10 * cx + inv._11 * cy + halfH;
+
+			// Clip the row to where the texture coordinates are inside the
+			// image and to the surface.
+			float loU, hiU, loV, hiV;
+			solve_span_( u0, du, float(aWidth), loU, hiU );
+			solve_span_( v0, dv, float(aHeight), loV, hiV );
+
+			float const lo = std::max( { loU, loV, 0.f } );
+			float const hi = std::min( { hiU, hiV, float(surfaceWidth) } );
+			if( !(lo < hi) )
+				continue;
+
+			int const beginX = std::max( 0, int(std::floor( lo )) - 1 );
+			int const endX = std::min( surfaceWidth, int(std::ceil( hi )) + 1 );
+
+			auto const fixedU = std::int32_t(std::lround( (u0 + du * float(beginX)) * kFixedOne ));
+			auto const fixedV = std::int32_t(std::lround( (v0 + dv * float(beginX)) * kFixedOne ));
+
+			aRow( y, beginX, endX, fixedU, fixedV, fixedDU, fixedDV );
+		}
+	}
+
+	void solve_span_( float aStart, float aStep, float aLimit, float& aLo, float& aHi ) noexcept
+	{
+		if( 0.f == aStep )
+		{
+			if( aStart >= 0.f && aStart < aLimit )
+			{
+				aLo = std::numeric_limits<float>::lowest();
+				aHi = std::numeric_limits<float>::max();
+			}
+			else
+			{
+				aLo = 0.f;
+				aHi = 0.f;
+			}
+			return;
+		}
+
+		float const a = (0.f - aStart) / aStep;
+		float const b = (aLimit - aStart) / aStep;
+
+		aLo = std::min( a, b );
+		aHi = std::max( a, b );
+	}
+}
+
+namespace detail
+{
+#	if defined(DRAW2D_TRANSFORM_BLIT_SSE2)
+	std::uint32_t bilerp( std::uint32_t aP00, std::uint32_t aP10, std::uint32_t aP01, std::uint32_t aP11, std::uint32_t aFX, std::uint32_t aFY ) noexcept
+	{
+		__m128i const zero = _mm_setzero_si128();
+
+		// Widen to 16 bits per channel: [p00 p10] and [p01 p11]
+		__m128i const top = _mm_unpacklo_epi8( _mm_set_epi32( 0, 0, int(aP10), int(aP00) ), zero );
+		__m128i const bot = _mm_unpacklo_epi8( _mm_set_epi32( 0, 0, int(aP11), int(aP01) ), zero );
+
+		// Vertical: (top*(256-fy) + bot*fy) >> 8. Products are at most
+		// 255*256, so they fit in unsigned 16 bits, as does their sum.
+		__m128i const wy0 = _mm_set1_epi16( short(256 - aFY) );
+		__m128i const wy1 = _mm_set1_epi16( short(aFY) );
+		__m128i const col = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( top, wy0 ), _mm_mullo_epi16( bot, wy1 ) ), 8 );
+
+		// Horizontal: left half weighted by (256-fx), right half by fx.
+		__m128i const wx = _mm_set_epi16( short(aFX), short(aFX), short(aFX), short(aFX), short(256 - aFX), short(256 - aFX), short(256 - aFX), short(256 - aFX) );
+		__m128i const prod = _mm_mullo_epi16( col, wx );
+		__m128i const sum = _mm_srli_epi16( _mm_add_epi16( prod, _mm_srli_si128( prod, 8 ) ), 8 );
+
+		return std::uint32_t(_mm_cvtsi128_si32( _mm_packus_epi16( sum, zero ) ));
+	}
+#	else // !SSE2
+	std::uint32_t bilerp( std::uint32_t aP00, std::uint32_t aP10, std::uint32_t aP01, std::uint32_t aP11, std::uint32_t aFX, std::uint32_t aFY ) noexcept
+	{
+		return bilerp_scalar( aP00, aP10, aP01, aP11, aFX, aFY );
+	}
+#	endif // ~ SSE2
+
+	std::uint32_t bilerp_scalar( std::uint32_t aP00, std::uint32_t aP10, std::uint32_t aP01, std::uint32_t aP11, std::uint32_t aFX, std::uint32_t aFY ) noexcept
+	{
+		// Same math as the SSE2 version, one byte lane at a time.
+		std::uint32_t ret = 0;
+		for( unsigned shift = 0; shift < 32; shift += 8 )
+		{
+			std::uint32_t const c00 = (aP00 >> shift) & 0xff;
+			std::uint32_t const c10 = (aP10 >> shift) & 0xff;
+			std::uint32_t const c01 = (aP01 >> shift) & 0xff;
+			std::uint32_t const c11 = (aP11 >> shift) & 0xff;
+
+			std::uint32_t const left = (c00 * (256 - aFY) + c01 * aFY) >> 8;
+			std::uint32_t const right = (c10 * (256 - aFY) + c11 * aFY) >> 8;
+			std::uint32_t const value = (left * (256 - aFX) + right * aFX) >> 8;
+
+			ret |= value << shift;
+		}
+		return ret;
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef TRANSFORM_BLIT_HPP_2F7C9B04_6D1E_4A3B_B8E5_91C0D4A7E256
+#define TRANSFORM_BLIT_HPP_2F7C9B04_6D1E_4A3B_B8E5_91C0D4A7E256
+
+#include <cstdint>
+
+#include "forward.hpp"
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/mat22.hpp"
+
+/** Texture sampling mode for the transformed blits
+ *
+ * nearest picks the texel that the pixel center falls into. bilinear blends
+ * the four closest texels, which avoids the shimmering of nearest sampling
+ * when sprites move, rotate or scale slowly. The mask is filtered along
+ * with the color (a pixel is drawn if it is at least half covered).
+ */
+enum class ESampleMode
+{
+	nearest,
+	bilinear
+};
+
+/** Blit an image with an arbitrary linear transform (rotation, scaling, ...)
+ *
+ * The image is placed in a local coordinate system with its center at the
+ * origin. Pixel (u,v) of the image thus covers the area around
+ *
+ *   local = (u + 0.5 - width/2, v + 0.5 - height/2).
+ *
+ * Like the shapes (see shape.hpp), local coordinates are transformed by the
+ * matrix and then translated:
+ *
+ *   surfacePosition = aTransform * local + aTranslation
+ *
+ * i.e., aTranslation is where the image's center ends up. With the identity
+ * matrix this draws the same pixels as blit_masked() at position
+ * aTranslation - (width/2, height/2) (for integer coordinates).
+ *
+ * The blit works by inverse mapping. The covered area of the surface is
+ * clipped first; for each row, the starting texture coordinate is computed
+ * once and then stepped per pixel in 16.16 fixed point (no per-pixel matrix
+ * multiplication). Sampling is nearest neighbour. Pixels are masked like in
+ * blit_masked() (alpha below 128 is discarded).
+ *
+ * Singular (non-invertible) transforms draw nothing.
+ */
+void blit_transformed(
+	Surface&,
+	ImageRGBA const&,
+	Mat22f const& aTransform,
+	Vec2f aTranslation
+);
+
+/** Blit a pre-swizzled sprite with an arbitrary linear transform
+ *
+ * See above. With ESampleMode::nearest, this produces the same result as
+ * blit_transformed() with the image that the sprite was made from, but uses
+ * the masked 32-bit copy of the sprite blits.
+ *
+ * ESampleMode::bilinear blends the texels with 8-bit fixed-point weights
+ * using SSE2 integer math where available (scalar code elsewhere). It covers
+ * the same pixels as nearest sampling; only the colors (and the mask along
+ * the sprite's edge) differ.
+ */
+void blit_transformed(
+	Surface&,
+	SpriteRGBx const&,
+	Mat22f const& aTransform,
+	Vec2f aTranslation,
+	ESampleMode = ESampleMode::nearest
+);
+
+namespace detail
+{
+	// Bilinear blend of four RGBx words with 8-bit weights aFX, aFY in
+	// [0,255], as used by ESampleMode::bilinear. aP00/aP10 are horizontal
+	// neighbours in one row, aP01/aP11 in the next. All four bytes are
+	// blended, including the padding byte that holds the sprite's mask.
+	//
+	// bilerp() uses SSE2 where available; bilerp_scalar() is the portable
+	// version (and what bilerp() is elsewhere). Both give identical results.
+	std::uint32_t bilerp( std::uint32_t aP00, std::uint32_t aP10, std::uint32_t aP01, std::uint32_t aP11, std::uint32_t aFX, std::uint32_t aFY ) noexcept;
+	std::uint32_t bilerp_scalar( std::uint32_t aP00, std::uint32_t aP10, std::uint32_t aP01, std::uint32_t aP11, std::uint32_t aFX, std::uint32_t aFY ) noexcept;
+}
+
+#endif // TRANSFORM_BLIT_HPP_2F7C9B04_6D1E_4A3B_B8E5_91C0D4A7E256
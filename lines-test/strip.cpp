@@ -0,0 +1,156 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include <cmath>
+
+#include "helpers.hpp"
+
+#include "../draw2d/surface.hpp"
+#include "../draw2d/shape.hpp"
+
+namespace
+{
+	std::size_t count_drawn_( Surface const& aSurface )
+	{
+		auto const counts = count_pixel_neighbours( aSurface );
+
+		std::size_t total = 0;
+		for( auto const count : counts )
+			total += count;
+
+		return total;
+	}
+
+	// How often each pixel is plotted when drawing aStrip (with the identity
+	// matrix) at aTranslation
+	std::vector<std::uint32_t> count_plots_( Surface const& aSurface, LineStrip const& aStrip, Vec2f aTranslation )
+	{
+		std::vector<Vec2f> points( aStrip.vertices(), aStrip.vertices() + aStrip.vertex_count() );
+		for( auto& point : points )
+			point = point + aTranslation;
+
+		std::vector<std::uint32_t> counts( std::size_t(aSurface.get_width()) * aSurface.get_height() );
+		detail::count_polyline_plots( aSurface, points.size(), points.data(), counts.data() );
+		return counts;
+	}
+
+	std::uint32_t max_plots_( std::vector<std::uint32_t> const& aCounts )
+	{
+		return *std::max_element( aCounts.begin(), aCounts.end() );
+	}
+
+	std::size_t total_plots_( std::vector<std::uint32_t> const& aCounts )
+	{
+		return std::accumulate( aCounts.begin(), aCounts.end(), std::size_t(0) );
+	}
+}
+
+TEST_CASE( "Line strips", "[strip]" )
+{
+	Surface surface( 64, 48 );
+	surface.clear();
+
+	Mat22f const identity{ 1.f, 0.f, 0.f, 1.f };
+	ColorF const white{ 1.f, 1.f, 1.f };
+
+	SECTION( "joints" )
+	{
+		// Three sides of a square. The two joints are shared by the
+		// segments: 21 + 20 + 20 pixels.
+		LineStrip const strip{ {
+			{ 5.f, 5.f },
+			{ 25.f, 5.f },
+			{ 25.f, 25.f },
+			{ 5.f, 25.f }
+		} };
+		strip.draw( surface, white, identity, { 0.f, 0.f } );
+
+		REQUIRE( 61 == count_drawn_( surface ) );
+
+		auto const counts = count_pixel_neighbours( surface );
+		REQUIRE( 2 == counts[1] );
+		REQUIRE( 0 == counts[0] );
+
+		// Each pixel, including the joints, is plotted exactly once.
+		auto const plots = count_plots_( surface, strip, { 0.f, 0.f } );
+		REQUIRE( 1 == max_plots_( plots ) );
+		REQUIRE( 61 == total_plots_( plots ) );
+	}
+
+	SECTION( "closed" )
+	{
+		// The last vertex equals the first one, so the strip's two ends meet
+		// at a pixel that both the first and the last segment plot. Only
+		// consecutive segments share a joint.
+		LineStrip const strip{ {
+			{ 5.f, 5.f },
+			{ 25.f, 5.f },
+			{ 25.f, 25.f },
+			{ 5.f, 25.f },
+			{ 5.f, 5.f }
+		} };
+
+		auto const plots = count_plots_( surface, strip, { 0.f, 0.f } );
+		REQUIRE( 2 == plots[5*64 + 5] );
+		REQUIRE( 81 == total_plots_( plots ) );
+	}
+
+	SECTION( "clipped" )
+	{
+		// Starts left of the surface, ends above it: 11 pixels on the first
+		// segment, 43 on the second (x=10, y=5..47), one of which is the
+		// joint.
+		LineStrip const strip{ {
+			{ -10.f, 5.f },
+			{ 10.f, 5.f },
+			{ 10.f, 60.f }
+		} };
+		strip.draw( surface, white, identity, { 0.f, 0.f } );
+
+		REQUIRE( 53 == count_drawn_( surface ) );
+
+		auto const plots = count_plots_( surface, strip, { 0.f, 0.f } );
+		REQUIRE( 1 == max_plots_( plots ) );
+		REQUIRE( 53 == total_plots_( plots ) );
+	}
+
+	SECTION( "leaving and reentering" )
+	{
+		// The middle segment is entirely outside; the outer ones are
+		// clipped where they cross the right border (x = 63).
+		LineStrip const strip{ {
+			{ 50.f, 10.f },
+			{ 80.f, 10.f },
+			{ 80.f, 30.f },
+			{ 50.f, 30.f }
+		} };
+		strip.draw( surface, white, identity, { 0.f, 0.f } );
+
+		REQUIRE( 28 == count_drawn_( surface ) );
+
+		auto const plots = count_plots_( surface, strip, { 0.f, 0.f } );
+		REQUIRE( 1 == max_plots_( plots ) );
+		REQUIRE( 28 == total_plots_( plots ) );
+	}
+
+	SECTION( "long trail" )
+	{
+		// Many short segments (spiral): the result must be connected.
+		std::vector<Vec2f> points;
+		for( int i = 0; i < 2000; ++i )
+		{
+			float const t = float(i) * 0.01f;
+			float const r = 2.f + t;
+			points.emplace_back( Vec2f{ r * std::cos( t ), r * std::sin( t ) } );
+		}
+
+		LineStrip const strip( points.size(), points.data() );
+		strip.draw( surface, white, identity, { 32.f, 24.f } );
+
+		auto const counts = count_pixel_neighbours( surface );
+		REQUIRE( 0 == counts[0] );
+	}
+}
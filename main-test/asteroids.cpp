@@ -0,0 +1,207 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+
+#include <cmath>
+
+#include "../main/asteroid_field.hpp"
+
+namespace
+{
+	constexpr float kTwoPi = 6.2831853071795865f;
+
+	// Field over [0,2000]x[0,500] (no padding) with exactly aCount asteroids
+	AsteroidField make_field_( std::size_t aCount, float aMaxSpeed = 500.f )
+	{
+		return AsteroidField( RNG( 1 ), 2000, 500, float(aCount) * 1e-6f, 100.f, aMaxSpeed, 1.5f, 0.f );
+	}
+
+	// Asteroid i at x = 100 + 250*i, far enough apart that they never touch.
+	// Angles include values that wrap around in either direction.
+	std::vector<AsteroidField::State> spread_out_( AsteroidField& aField, unsigned aSeed )
+	{
+		std::minstd_rand rng( aSeed );
+		std::uniform_real_distribution<float> vel( -50.f, 50.f );
+		std::uniform_real_distribution<float> angle( 0.f, kTwoPi );
+		std::uniform_real_distribution<float> rot( -3.f, 3.f );
+		std::uniform_real_distribution<float> y( 100.f, 400.f );
+
+		std::vector<AsteroidField::State> states;
+		for( std::size_t i = 0; i < aField.asteroid_count(); ++i )
+		{
+			auto state = aField.get_state( i );
+			state.position = Vec2f{ 100.f + 250.f * float(i), y( rng ) };
+			state.velocity = Vec2f{ vel( rng ), vel( rng ) };
+			state.angle = angle( rng );
+			state.radpersec = rot( rng );
+
+			if( 1 == i % 3 )
+			{
+				state.angle = kTwoPi - 0.001f;
+				state.radpersec = 2.f;
+			}
+			else if( 2 == i % 3 )
+			{
+				state.angle = 0.001f;
+				state.radpersec = -2.f;
+			}
+
+			aField.set_state( i, state );
+			states.emplace_back( state );
+		}
+
+		return states;
+	}
+
+	// Scalar reference for one (collision-free) update
+	AsteroidField::State step_( AsteroidField::State aState, float aDt, Vec2f aMovement )
+	{
+		aState.position.x = aState.position.x + aState.velocity.x * aDt - aMovement.x;
+		aState.position.y = aState.position.y + aState.velocity.y * aDt - aMovement.y;
+
+		float a = aState.angle + aState.radpersec * aDt;
+		if( a >= kTwoPi ) a -= kTwoPi;
+		if( a < 0.f ) a += kTwoPi;
+		aState.angle = a;
+
+		return aState;
+	}
+
+	void require_same_( AsteroidField::State const& aExpected, AsteroidField::State const& aActual, float aTolerance )
+	{
+		REQUIRE( std::abs( aExpected.position.x - aActual.position.x ) <= aTolerance );
+		REQUIRE( std::abs( aExpected.position.y - aActual.position.y ) <= aTolerance );
+		REQUIRE( std::abs( aExpected.angle - aActual.angle ) <= aTolerance );
+
+		REQUIRE( aExpected.velocity.x == aActual.velocity.x );
+		REQUIRE( aExpected.velocity.y == aActual.velocity.y );
+		REQUIRE( aExpected.radpersec == aActual.radpersec );
+		REQUIRE( aExpected.prototype == aActual.prototype );
+		REQUIRE( aExpected.scale == aActual.scale );
+		REQUIRE( aExpected.tint.r == aActual.tint.r );
+		REQUIRE( aExpected.tint.g == aActual.tint.g );
+		REQUIRE( aExpected.tint.b == aActual.tint.b );
+	}
+}
+
+TEST_CASE( "Asteroid field update", "[asteroids]" )
+{
+	float const dt = 1.f / 60.f;
+	Vec2f const movement{ 0.75f, -0.5f };
+
+	SECTION( "matches scalar reference" )
+	{
+		// Sizes with and without a tail after the groups of four
+		for( std::size_t count : { 3u, 4u, 5u, 6u, 7u, 8u } )
+		{
+			auto field = make_field_( count );
+			REQUIRE( count == field.asteroid_count() );
+
+			auto const before = spread_out_( field, unsigned(count) );
+			field.update( dt, movement );
+
+			REQUIRE( count == field.asteroid_count() );
+			for( std::size_t i = 0; i < count; ++i )
+			{
+				INFO( "count " << count << ", asteroid " << i );
+
+				auto const state = field.get_state( i );
+				require_same_( step_( before[i], dt, movement ), state, 1e-3f );
+
+				REQUIRE( state.angle >= 0.f );
+				REQUIRE( state.angle < kTwoPi );
+			}
+		}
+	}
+
+	SECTION( "respawns" )
+	{
+		// Asteroid 1 is in the first group of four, asteroid 5 in the tail.
+		// Both leave through the right border and come back at the left.
+		auto field = make_field_( 7 );
+		auto const before = spread_out_( field, 7 );
+
+		for( std::size_t i : { 1u, 5u } )
+		{
+			auto state = before[i];
+			state.position.x = 1995.f;
+			state.velocity.x = 450.f;
+			field.set_state( i, state );
+		}
+
+		field.update( dt, movement );
+
+		for( std::size_t i = 0; i < 7; ++i )
+		{
+			INFO( "asteroid " << i );
+
+			auto const state = field.get_state( i );
+			if( 1 == i || 5 == i )
+			{
+				REQUIRE( 0.f == state.position.x );
+				REQUIRE( state.position.y >= 0.f );
+				REQUIRE( state.position.y <= 500.f );
+			}
+			else
+			{
+				require_same_( step_( before[i], dt, movement ), state, 1e-3f );
+			}
+		}
+	}
+}
+
+TEST_CASE( "Asteroid field resize", "[asteroids]" )
+{
+	SECTION( "shrinking keeps survivors in order" )
+	{
+		// Eight asteroids; the odd ones are outside of the smaller area. The
+		// new area holds exactly the four survivors.
+		auto field = make_field_( 8 );
+		auto before = spread_out_( field, 8 );
+
+		for( std::size_t i = 0; i < 8; ++i )
+		{
+			before[i].position.x = (i % 2) ? 1100.f + 100.f * float(i) : 100.f + 100.f * float(i);
+			field.set_state( i, before[i] );
+		}
+
+		field.resize( 1000, 500 );
+		REQUIRE( 4 == field.asteroid_count() );
+
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			INFO( "asteroid " << i );
+			require_same_( before[2*i], field.get_state( i ), 0.f );
+			REQUIRE( before[2*i].position.x == field.get_position( i ).x );
+		}
+	}
+
+	SECTION( "growing keeps everyone" )
+	{
+		auto field = make_field_( 8 );
+		auto const before = spread_out_( field, 9 );
+
+		std::vector<float> radii;
+		for( std::size_t i = 0; i < 8; ++i )
+			radii.emplace_back( field.get_radius( i ) );
+
+		field.resize( 3000, 500 );
+		REQUIRE( 12 == field.asteroid_count() );
+
+		for( std::size_t i = 0; i < 8; ++i )
+		{
+			INFO( "asteroid " << i );
+			require_same_( before[i], field.get_state( i ), 0.f );
+			REQUIRE( radii[i] == field.get_radius( i ) );
+		}
+
+		// New asteroids appear in the added area
+		for( std::size_t i = 8; i < 12; ++i )
+		{
+			auto const pos = field.get_position( i );
+			REQUIRE( pos.x >= 2000.f );
+			REQUIRE( pos.x <= 3000.f );
+		}
+	}
+}
@@ -0,0 +1,261 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <cmath>
+
+#include "../main/sweep_prune.hpp"
+#include "../main/asteroid_field.hpp"
+
+namespace
+{
+	using Pairs_ = std::vector<std::pair<std::uint32_t,std::uint32_t>>;
+
+	// O(n^2) reference: all pairs whose boxes overlap like in the sweep
+	Pairs_ brute_force_( std::vector<float> const& aX, std::vector<float> const& aY, std::vector<float> const& aRadius )
+	{
+		Pairs_ ret;
+		for( std::uint32_t i = 0; i < aX.size(); ++i )
+		{
+			for( std::uint32_t j = i+1; j < aX.size(); ++j )
+			{
+				float const minI = aX[i] - aRadius[i], minJ = aX[j] - aRadius[j];
+				bool const inX = minI <= minJ
+					? minJ <= minI + 2.f*aRadius[i]
+					: minI <= minJ + 2.f*aRadius[j]
+				;
+				bool const inY = std::abs( aY[j] - aY[i] ) < aRadius[i] + aRadius[j];
+
+				if( inX && inY )
+					ret.emplace_back( i, j );
+			}
+		}
+		return ret;
+	}
+
+	Pairs_ sweep_( SweepAndPrune& aSweep, std::vector<float> const& aX, std::vector<float> const& aY, std::vector<float> const& aRadius )
+	{
+		std::vector<SweepAndPrune::Pair> pairs;
+		aSweep.find_pairs( aX.size(), aX.data(), aY.data(), aRadius.data(), pairs );
+
+		Pairs_ ret;
+		for( auto const& pair : pairs )
+		{
+			// a's box starts first
+			REQUIRE( aX[pair.a] - aRadius[pair.a] <= aX[pair.b] - aRadius[pair.b] );
+			ret.emplace_back( std::min( pair.a, pair.b ), std::max( pair.a, pair.b ) );
+		}
+
+		std::sort( ret.begin(), ret.end() );
+		return ret;
+	}
+
+	// Field over [0,2000]x[0,500] (no padding) with exactly two asteroids
+	AsteroidField make_pair_field_( float aMaxSpeed )
+	{
+		return AsteroidField( RNG( 3 ), 2000, 500, 2e-6f, 100.f, aMaxSpeed, 1.5f, 0.f );
+	}
+
+	// Place two asteroids of the same prototype; they overlap by 2 pixels
+	// along aDir (unit vector) from the first to the second.
+	void place_pair_( AsteroidField& aField, float aScaleA, float aScaleB, Vec2f aDir, Vec2f aVelA, Vec2f aVelB )
+	{
+		auto a = aField.get_state( 0 );
+		a.prototype = 0;
+		a.scale = aScaleA;
+		a.position = Vec2f{ 1000.f, 250.f };
+		a.velocity = aVelA;
+		aField.set_state( 0, a );
+
+		auto b = aField.get_state( 1 );
+		b.prototype = 0;
+		b.scale = aScaleB;
+		b.velocity = aVelB;
+		aField.set_state( 1, b );
+
+		float const reach = aField.get_radius( 0 ) + aField.get_radius( 1 );
+		b.position = a.position + (reach - 2.f) * aDir;
+		aField.set_state( 1, b );
+	}
+
+	float length_( Vec2f aV )
+	{
+		return std::sqrt( dot( aV, aV ) );
+	}
+}
+
+TEST_CASE( "Sweep and prune", "[collide]" )
+{
+	std::minstd_rand rng( 5 );
+	std::uniform_real_distribution<float> pos( 0.f, 1000.f );
+	std::uniform_real_distribution<float> size( 2.f, 40.f );
+
+	SweepAndPrune sweep;
+
+	SECTION( "same pairs as brute force" )
+	{
+		// Sizes with and without a tail after the groups of four
+		for( std::size_t count : { 0u, 1u, 2u, 3u, 5u, 8u, 13u, 200u, 1001u } )
+		{
+			std::vector<float> x, y, r;
+			for( std::size_t i = 0; i < count; ++i )
+			{
+				x.emplace_back( pos( rng ) );
+				y.emplace_back( pos( rng ) );
+				r.emplace_back( size( rng ) );
+			}
+
+			INFO( "count " << count );
+			REQUIRE( brute_force_( x, y, r ) == sweep_( sweep, x, y, r ) );
+		}
+	}
+
+	SECTION( "order is kept between calls" )
+	{
+		// Small moves keep the order nearly sorted; a few circles jump
+		// across the whole area (like respawned asteroids).
+		std::vector<float> x, y, r;
+		for( std::size_t i = 0; i < 500; ++i )
+		{
+			x.emplace_back( pos( rng ) );
+			y.emplace_back( pos( rng ) );
+			r.emplace_back( size( rng ) );
+		}
+
+		std::uniform_real_distribution<float> jitter( -3.f, 3.f );
+		for( int step = 0; step < 20; ++step )
+		{
+			REQUIRE( brute_force_( x, y, r ) == sweep_( sweep, x, y, r ) );
+
+			for( std::size_t i = 0; i < x.size(); ++i )
+			{
+				x[i] += jitter( rng );
+				y[i] += jitter( rng );
+			}
+			for( std::size_t i = 0; i < 5; ++i )
+				x[(step*37 + i*101) % x.size()] = pos( rng );
+		}
+	}
+
+	SECTION( "touching boxes" )
+	{
+		// Boxes that touch along x are candidates; along y they are not.
+		// The first pair is found in a full group of four candidates, the
+		// last one in the tail.
+		std::vector<float> const x{ 0.f, 2.f, 0.f, 10.f, 20.f, 30.f, 40.f, 42.f };
+		std::vector<float> const y{ 0.f, 0.f, 2.f, 10.f, 0.f, 0.f, 0.f, 0.f };
+		std::vector<float> const r( 8, 1.f );
+
+		REQUIRE( Pairs_{ { 0, 1 }, { 6, 7 } } == sweep_( sweep, x, y, r ) );
+	}
+
+	SECTION( "identical circles" )
+	{
+		std::vector<float> const x( 7, 5.f ), y( 7, 5.f ), r( 7, 1.f );
+		REQUIRE( 21 == sweep_( sweep, x, y, r ).size() );
+	}
+}
+
+TEST_CASE( "Asteroid collisions", "[collide][asteroids]" )
+{
+	SECTION( "head-on" )
+	{
+		// Different masses (scales), moving towards each other along x. Mass
+		// is proportional to the squared radius.
+		auto field = make_pair_field_( 1e4f );
+		place_pair_( field, 0.8f, 1.25f, Vec2f{ 1.f, 0.f }, Vec2f{ 120.f, 0.f }, Vec2f{ -80.f, 0.f } );
+
+		float const massA = field.get_radius( 0 ) * field.get_radius( 0 );
+		float const massB = field.get_radius( 1 ) * field.get_radius( 1 );
+
+		auto const a0 = field.get_state( 0 ), b0 = field.get_state( 1 );
+
+		// A zero time step only resolves collisions.
+		field.update( 0.f, { 0.f, 0.f } );
+
+		auto const a1 = field.get_state( 0 ), b1 = field.get_state( 1 );
+
+		// Momentum and kinetic energy are conserved.
+		Vec2f const p0 = massA * a0.velocity + massB * b0.velocity;
+		Vec2f const p1 = massA * a1.velocity + massB * b1.velocity;
+		REQUIRE( std::abs( p0.x - p1.x ) <= 1e-4f * massA * 120.f );
+		REQUIRE( std::abs( p0.y - p1.y ) <= 1e-4f * massA * 120.f );
+
+		float const e0 = massA * dot( a0.velocity, a0.velocity ) + massB * dot( b0.velocity, b0.velocity );
+		float const e1 = massA * dot( a1.velocity, a1.velocity ) + massB * dot( b1.velocity, b1.velocity );
+		REQUIRE( std::abs( e0 - e1 ) <= 1e-4f * e0 );
+
+		// 1D elastic collision
+		float const expectedA = ((massA - massB) * 120.f + 2.f * massB * -80.f) / (massA + massB);
+		float const expectedB = ((massB - massA) * -80.f + 2.f * massA * 120.f) / (massA + massB);
+		REQUIRE( std::abs( expectedA - a1.velocity.x ) <= 1e-3f );
+		REQUIRE( std::abs( expectedB - b1.velocity.x ) <= 1e-3f );
+
+		// Separated along the line between the centers; the lighter one
+		// moves further.
+		float const dist = length_( b1.position - a1.position );
+		REQUIRE( dist >= field.get_radius( 0 ) + field.get_radius( 1 ) - 1e-3f );
+		REQUIRE( a1.position.y == a0.position.y );
+		REQUIRE( b1.position.y == b0.position.y );
+		REQUIRE( a0.position.x - a1.position.x > b1.position.x - b0.position.x );
+	}
+
+	SECTION( "separating pairs keep their velocity" )
+	{
+		auto field = make_pair_field_( 1e4f );
+		place_pair_( field, 1.f, 1.f, Vec2f{ 0.6f, 0.8f }, Vec2f{ -10.f, 0.f }, Vec2f{ 10.f, 0.f } );
+
+		auto const a0 = field.get_state( 0 ), b0 = field.get_state( 1 );
+		field.update( 0.f, { 0.f, 0.f } );
+
+		REQUIRE( a0.velocity.x == field.get_state( 0 ).velocity.x );
+		REQUIRE( b0.velocity.x == field.get_state( 1 ).velocity.x );
+	}
+
+	SECTION( "speed limit" )
+	{
+		// A heavy asteroid hits a light one at rest, off-center. Unlimited,
+		// the light one would leave at about 1.4 times the maximum speed.
+		float const maxSpeed = 500.f;
+		auto field = make_pair_field_( maxSpeed );
+
+		Vec2f const dir{ 0.96f, 0.28f };
+		place_pair_( field, 1.3f, 0.7f, dir, Vec2f{ 480.f, 0.f }, Vec2f{ 0.f, 0.f } );
+
+		float const massA = field.get_radius( 0 ) * field.get_radius( 0 );
+		float const massB = field.get_radius( 1 ) * field.get_radius( 1 );
+
+		field.update( 0.f, { 0.f, 0.f } );
+
+		// Unlimited result, along the normal between the centers after
+		// separation. (Separation moves both along the same direction.)
+		auto const a1 = field.get_state( 0 ), b1 = field.get_state( 1 );
+		Vec2f const n = (1.f / length_( b1.position - a1.position )) * (b1.position - a1.position);
+
+		float const vn = dot( Vec2f{ -480.f, 0.f }, n );
+		float const impulse = 2.f * vn / (massA + massB);
+		Vec2f const freeA = Vec2f{ 480.f, 0.f } + (impulse * massB) * n;
+		Vec2f const freeB = -(impulse * massA) * n;
+		REQUIRE( length_( freeB ) > 1.2f * maxSpeed );
+
+		for( auto const& [got, free] : { std::pair{ a1.velocity, freeA }, std::pair{ b1.velocity, freeB } } )
+		{
+			float const speed = length_( got );
+			REQUIRE( speed <= maxSpeed * (1.f + 1e-6f) );
+
+			// Same direction as the unlimited velocity
+			float const cross = got.x * free.y - got.y * free.x;
+			REQUIRE( std::abs( cross ) <= 1e-4f * speed * length_( free ) );
+			REQUIRE( dot( got, free ) > 0.f );
+
+			// Only scaled if needed
+			if( length_( free ) <= maxSpeed )
+				REQUIRE( std::abs( speed - length_( free ) ) <= 1e-3f );
+		}
+
+		REQUIRE( std::abs( length_( b1.velocity ) - maxSpeed ) <= 1e-2f );
+	}
+}
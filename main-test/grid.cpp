@@ -0,0 +1,186 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+#include "../main/asteroid_field.hpp"
+#include "../main/spatial_grid.hpp"
+
+namespace
+{
+	std::vector<std::uint32_t> sorted_( std::vector<std::uint32_t> aIndices )
+	{
+		std::sort( aIndices.begin(), aIndices.end() );
+		return aIndices;
+	}
+}
+
+TEST_CASE( "Spatial grid queries", "[grid]" )
+{
+	// Points in [0,1000]x[0,500], with some far outside of the grid's bounds.
+	// Those end up in the border cells.
+	std::minstd_rand rng( 1 );
+	std::uniform_real_distribution<float> inX( 0.f, 1000.f ), inY( 0.f, 500.f );
+	std::uniform_real_distribution<float> anyX( -800.f, 1800.f ), anyY( -600.f, 1100.f );
+
+	std::vector<float> xs, ys;
+	for( int i = 0; i < 2000; ++i )
+	{
+		bool const outside = 0 == i % 10;
+		xs.emplace_back( outside ? anyX( rng ) : inX( rng ) );
+		ys.emplace_back( outside ? anyY( rng ) : inY( rng ) );
+	}
+
+	xs.emplace_back( -1e6f ); ys.emplace_back( 250.f );
+	xs.emplace_back( 500.f ); ys.emplace_back( 1e6f );
+	xs.emplace_back( 1e6f ); ys.emplace_back( -1e6f );
+
+	SpatialGrid grid( 64.f );
+	grid.build( xs.size(), xs.data(), ys.data(), { 0.f, 0.f }, { 1000.f, 500.f } );
+
+	std::uniform_real_distribution<float> extent( 0.f, 400.f );
+
+	SECTION( "radius" )
+	{
+		for( int q = 0; q < 500; ++q )
+		{
+			Vec2f const center{ anyX( rng ), anyY( rng ) };
+			float const radius = extent( rng );
+
+			std::vector<std::uint32_t> expected;
+			for( std::size_t i = 0; i < xs.size(); ++i )
+			{
+				float const dx = xs[i] - center.x, dy = ys[i] - center.y;
+				if( dx*dx + dy*dy <= radius*radius )
+					expected.emplace_back( std::uint32_t(i) );
+			}
+
+			std::vector<std::uint32_t> found;
+			grid.query_radius( center, radius, found );
+
+			INFO( "query " << q );
+			REQUIRE( expected == sorted_( found ) );
+		}
+	}
+
+	SECTION( "aabb" )
+	{
+		for( int q = 0; q < 500; ++q )
+		{
+			Vec2f const min{ anyX( rng ), anyY( rng ) };
+			Vec2f const max = min + Vec2f{ extent( rng ), extent( rng ) };
+
+			std::vector<std::uint32_t> expected;
+			for( std::size_t i = 0; i < xs.size(); ++i )
+			{
+				if( xs[i] >= min.x && xs[i] <= max.x && ys[i] >= min.y && ys[i] <= max.y )
+					expected.emplace_back( std::uint32_t(i) );
+			}
+
+			std::vector<std::uint32_t> found;
+			grid.query_aabb( min, max, found );
+
+			INFO( "query " << q );
+			REQUIRE( expected == sorted_( found ) );
+		}
+	}
+
+	SECTION( "far outside" )
+	{
+		std::vector<std::uint32_t> found;
+		grid.query_radius( { -1e6f, 250.f }, 1.f, found );
+		grid.query_aabb( { 499.f, 9e5f }, { 501.f, 2e6f }, found );
+		grid.query_radius( { 1e6f, -1e6f }, 0.f, found );
+
+		REQUIRE( sorted_( found ) == std::vector<std::uint32_t>{ 2000, 2001, 2002 } );
+	}
+}
+
+TEST_CASE( "Asteroid field queries", "[grid][asteroids]" )
+{
+	// 1400x1200 simulation area (with padding); about 340 asteroids.
+	AsteroidField field( RNG( 2 ), 800, 600, 2e-4f );
+	REQUIRE( field.asteroid_count() > 300 );
+
+	// Move a few asteroids out of the grid's bounds
+	Vec2f const outside[] = {
+		{ -1000.f, 50.f },
+		{ 3000.f, 3000.f },
+		{ -450.f, -420.f },
+		{ 1500.f, 300.f },
+		{ 400.f, 5000.f }
+	};
+	for( std::size_t i = 0; i < std::size( outside ); ++i )
+	{
+		auto state = field.get_state( 7*i );
+		state.position = outside[i];
+		field.set_state( 7*i, state );
+	}
+
+	std::minstd_rand rng( 3 );
+	std::uniform_real_distribution<float> anyX( -1200.f, 3200.f ), anyY( -1200.f, 5200.f );
+	std::uniform_real_distribution<float> extent( 0.f, 600.f );
+
+	SECTION( "radius" )
+	{
+		for( int q = 0; q < 500; ++q )
+		{
+			// Every other query is centered on one of the moved asteroids.
+			Vec2f const center = (q % 2) ? outside[(q/2) % std::size( outside )] : Vec2f{ anyX( rng ), anyY( rng ) };
+			float const radius = extent( rng );
+
+			std::vector<std::uint32_t> expected;
+			for( std::size_t i = 0; i < field.asteroid_count(); ++i )
+			{
+				Vec2f const d = field.get_position( i ) - center;
+				float const reach = radius + field.get_radius( i );
+				if( dot( d, d ) <= reach*reach )
+					expected.emplace_back( std::uint32_t(i) );
+			}
+
+			std::vector<std::uint32_t> found;
+			field.query_radius( center, radius, found );
+
+			INFO( "query " << q );
+			REQUIRE( expected == sorted_( found ) );
+		}
+	}
+
+	SECTION( "aabb" )
+	{
+		for( int q = 0; q < 500; ++q )
+		{
+			Vec2f const min = (q % 2) ? outside[(q/2) % std::size( outside )] - Vec2f{ 10.f, 10.f } : Vec2f{ anyX( rng ), anyY( rng ) };
+			Vec2f const max = min + Vec2f{ extent( rng ), extent( rng ) };
+
+			std::vector<std::uint32_t> expected;
+			for( std::size_t i = 0; i < field.asteroid_count(); ++i )
+			{
+				Vec2f const pos = field.get_position( i );
+				Vec2f const d = pos - Vec2f{ std::clamp( pos.x, min.x, max.x ), std::clamp( pos.y, min.y, max.y ) };
+				float const radius = field.get_radius( i );
+				if( dot( d, d ) <= radius*radius )
+					expected.emplace_back( std::uint32_t(i) );
+			}
+
+			std::vector<std::uint32_t> found;
+			field.query_aabb( min, max, found );
+
+			INFO( "query " << q );
+			REQUIRE( expected == sorted_( found ) );
+		}
+	}
+
+	SECTION( "appends" )
+	{
+		// Queries append to the output and leave earlier entries alone
+		std::vector<std::uint32_t> found{ 12345u };
+		field.query_radius( outside[0], 1.f, found );
+
+		REQUIRE( 2 == found.size() );
+		REQUIRE( 12345u == found[0] );
+		REQUIRE( 0u == found[1] );
+	}
+}
@@ -0,0 +1,141 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <vector>
+
+#include <cmath>
+
+#include "../draw2d/shape.hpp"
+
+#include "../main/asteroid_field.hpp"
+
+namespace
+{
+	// A single asteroid over [0,2000]x[0,500]
+	AsteroidField make_single_()
+	{
+		return AsteroidField( RNG( 7 ), 2000, 500, 1e-6f, 100.f, 500.f, 1.5f, 0.f );
+	}
+
+	void place_( AsteroidField& aField, float aAngle, float aScale )
+	{
+		REQUIRE( 1 == aField.asteroid_count() );
+
+		auto state = aField.get_state( 0 );
+		state.position = Vec2f{ 1000.f, 250.f };
+		state.angle = aAngle;
+		state.scale = aScale;
+		state.prototype = 0;
+		aField.set_state( 0, state );
+	}
+
+	// The strip is given in the asteroid's local space and placed with the
+	// asteroid's transform.
+	std::vector<std::uint32_t> query_( AsteroidField const& aField, std::vector<Vec2f> const& aLocal )
+	{
+		auto const state = aField.get_state( 0 );
+		Mat22f const xform = Mat22f{ state.scale, 0.f, 0.f, state.scale } * make_rotation_2d( state.angle );
+
+		std::vector<std::uint32_t> ret;
+		aField.query_line_strip( LineStrip( aLocal.size(), aLocal.data() ), xform, state.position, ret );
+		return ret;
+	}
+
+	float length_( Vec2f aV )
+	{
+		return std::sqrt( dot( aV, aV ) );
+	}
+}
+
+TEST_CASE( "Line strip vs. asteroid", "[narrowphase]" )
+{
+	auto field = make_single_();
+	place_( field, 0.7f, 1.25f );
+	auto const& fan = field.get_prototype( 0 );
+
+	Vec2f const center = fan.vertices()[0];
+	Vec2f const* const rim = fan.vertices() + 1;
+	std::size_t const rimCount = fan.vertex_count() - 1;
+	float const bound = fan.bounding_radius();
+
+	std::vector<std::uint32_t> const hit{ 0 }, miss;
+
+	SECTION( "segment crossing one triangle" )
+	{
+		// Along the ray from the center through the middle of a rim edge.
+		// Only that edge's triangle covers the ray; the segment starts
+		// inside of it and ends outside of the bounding circle.
+		for( std::size_t k = 0; k < rimCount; ++k )
+		{
+			Vec2f const mid = 0.5f * (rim[k] + rim[(k+1) % rimCount]);
+			Vec2f const dir = (1.f / length_( mid - center )) * (mid - center);
+
+			std::vector<Vec2f> const segment{ center + 0.5f * (mid - center), center + (1.5f * bound) * dir };
+
+			INFO( "edge " << k );
+			REQUIRE( detail::outline_hits_fan( 2, segment.data(), fan.vertex_count(), fan.vertices() ) );
+			REQUIRE( hit == query_( field, segment ) );
+
+			// Completely inside, close to the rim. Only the endpoints can
+			// tell.
+			std::vector<Vec2f> const inside{ center + 0.8f * (mid - center), center + 0.9f * (mid - center) };
+			REQUIRE( hit == query_( field, inside ) );
+
+			// No endpoint inside: from outside, through the triangle and
+			// out on the other side of the asteroid
+			std::vector<Vec2f> const through{ center + (1.5f * bound) * dir, center - (1.5f * bound) * dir };
+			REQUIRE( hit == query_( field, through ) );
+		}
+	}
+
+	SECTION( "segment inside the bounding circle" )
+	{
+		// Beyond the rim vertex closest to the center, along the ray through
+		// it. The rim only touches the ray at the vertex.
+		std::size_t closest = 0;
+		for( std::size_t k = 1; k < rimCount; ++k )
+		{
+			if( length_( rim[k] - center ) < length_( rim[closest] - center ) )
+				closest = k;
+		}
+
+		float const near = length_( rim[closest] - center );
+		REQUIRE( bound - near > 1.f );
+
+		Vec2f const dir = (1.f / near) * (rim[closest] - center);
+		std::vector<Vec2f> const segment{
+			center + (near + 0.25f * (bound - near)) * dir,
+			center + (near + 0.75f * (bound - near)) * dir
+		};
+
+		for( auto const& p : segment )
+			REQUIRE( length_( p ) < bound );
+
+		REQUIRE( !detail::outline_hits_fan( 2, segment.data(), fan.vertex_count(), fan.vertices() ) );
+		REQUIRE( miss == query_( field, segment ) );
+	}
+
+	SECTION( "closed strip around the asteroid" )
+	{
+		float const s = 2.f * bound;
+		std::vector<Vec2f> const square{ { -s, -s }, { s, -s }, { s, s }, { -s, s }, { -s, -s } };
+		REQUIRE( !detail::outline_hits_fan( square.size(), square.data(), fan.vertex_count(), fan.vertices() ) );
+		REQUIRE( hit == query_( field, square ) );
+
+		// Same strip, next to the asteroid
+		std::vector<Vec2f> beside = square;
+		for( auto& p : beside )
+			p.x += 3.f * s;
+		REQUIRE( miss == query_( field, beside ) );
+	}
+
+	SECTION( "open strip around the asteroid" )
+	{
+		// Only a closed strip has an inside, even if the gap is tiny.
+		float const s = 2.f * bound;
+		std::vector<Vec2f> const open{ { -s, -s }, { s, -s }, { s, s }, { -s, s } };
+		REQUIRE( miss == query_( field, open ) );
+
+		std::vector<Vec2f> const gap{ { -s, -s }, { s, -s }, { s, s }, { -s, s }, { -s, -s + 0.01f } };
+		REQUIRE( miss == query_( field, gap ) );
+	}
+}
@@ -0,0 +1,163 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "../main/philox.hpp"
+
+namespace
+{
+	// Same conversion as Philox4x32::fill_uniform(): top 24 bits to [0,1)
+	float to_unit_( std::uint32_t aBits )
+	{
+		return float(aBits >> 8) * (1.f / 16777216.f);
+	}
+}
+
+TEST_CASE( "Philox random numbers", "[rng]" )
+{
+	SECTION( "known answers" )
+	{
+		// Test vectors from the Random123 distribution (kat_vectors). The
+		// counter is { block lo, block hi, stream lo, stream hi } and the
+		// key is { seed lo, seed hi }.
+		std::uint32_t out[4];
+
+		Philox4x32::generate_block( 0, 0, 0, out );
+		REQUIRE( 0x6627e8d5u == out[0] );
+		REQUIRE( 0xe169c58du == out[1] );
+		REQUIRE( 0xbc57ac4cu == out[2] );
+		REQUIRE( 0x9b00dbd8u == out[3] );
+
+		Philox4x32::generate_block( ~std::uint64_t(0), ~std::uint64_t(0), ~std::uint64_t(0), out );
+		REQUIRE( 0x408f276du == out[0] );
+		REQUIRE( 0x41c83b0eu == out[1] );
+		REQUIRE( 0xa20bc7c6u == out[2] );
+		REQUIRE( 0x6d5451fdu == out[3] );
+
+		Philox4x32::generate_block( 0x299f31d0a4093822ull, 0x0370734413198a2eull, 0x85a308d3243f6a88ull, out );
+		REQUIRE( 0xd16cfe09u == out[0] );
+		REQUIRE( 0x94fdccebu == out[1] );
+		REQUIRE( 0x5001e420u == out[2] );
+		REQUIRE( 0x24126ea1u == out[3] );
+	}
+
+	SECTION( "operator() concatenates blocks" )
+	{
+		Philox4x32 rng( 17, 23 );
+		for( std::uint64_t block = 0; block < 8; ++block )
+		{
+			std::uint32_t out[4];
+			Philox4x32::generate_block( 17, 23, block, out );
+
+			for( auto const expected : out )
+				REQUIRE( expected == rng() );
+		}
+	}
+
+	SECTION( "fill_uniform matches operator()" )
+	{
+		// Counts cover the 8-block (AVX2) and 4-block (SSE2) paths, the
+		// scalar block tail, partial blocks, and more than one chunk. The
+		// offsets leave values of a partially consumed block to drain.
+		std::size_t const counts[] = { 0, 1, 3, 4, 13, 16, 31, 32, 47, 63, 64, 100, 255, 256, 257, 1000 };
+		std::size_t const offsets[] = { 0, 1, 2, 3, 4, 5 };
+
+		for( auto const offset : offsets )
+		{
+			for( auto const count : counts )
+			{
+				Philox4x32 bulk( 0x123456789abcdefull, 99 );
+				Philox4x32 ref( 0x123456789abcdefull, 99 );
+
+				for( std::size_t i = 0; i < offset; ++i )
+				{
+					bulk();
+					ref();
+				}
+
+				std::vector<float> values( count );
+				bulk.fill_uniform( count, values.data(), -2.f, 6.f );
+
+				for( std::size_t i = 0; i < count; ++i )
+				{
+					float const expected = -2.f + 8.f * to_unit_( ref() );
+					REQUIRE( std::abs( expected - values[i] ) <= 1e-6f );
+				}
+
+				// The stream continues where the bulk fill stopped
+				REQUIRE( ref() == bulk() );
+			}
+		}
+	}
+
+	SECTION( "fill_uniform matches generate_block" )
+	{
+		std::size_t const blocks = 37;
+
+		Philox4x32 rng( 5, 6 );
+		std::vector<float> values( 4*blocks );
+		rng.fill_uniform( values.size(), values.data() );
+
+		for( std::size_t block = 0; block < blocks; ++block )
+		{
+			std::uint32_t out[4];
+			Philox4x32::generate_block( 5, 6, block, out );
+
+			for( std::size_t i = 0; i < 4; ++i )
+				REQUIRE( to_unit_( out[i] ) == values[4*block+i] );
+		}
+	}
+
+	SECTION( "fill_normal matches operator()" )
+	{
+		std::size_t const counts[] = { 1, 2, 7, 64, 65, 300 };
+		for( auto const count : counts )
+		{
+			Philox4x32 bulk( 3, 4 ), ref( 3, 4 );
+			bulk();
+			ref();
+
+			std::vector<float> values( count );
+			bulk.fill_normal( count, values.data(), 1.f, 2.f );
+
+			for( std::size_t i = 0; i < count; i += 2 )
+			{
+				float const u1 = float((ref() >> 8) + 1) * (1.f / 16777216.f);
+				float const u2 = to_unit_( ref() );
+
+				float const r = 2.f * std::sqrt( -2.f * std::log( u1 ) );
+				float const theta = 2.f * 3.1415926535897932385f * u2;
+
+				REQUIRE( std::abs( 1.f + r * std::cos( theta ) - values[i] ) <= 1e-5f );
+				if( i+1 < count )
+					REQUIRE( std::abs( 1.f + r * std::sin( theta ) - values[i+1] ) <= 1e-5f );
+			}
+
+			// Odd counts consume a whole pair
+			REQUIRE( ref() == bulk() );
+		}
+	}
+
+	SECTION( "fill_normal distribution" )
+	{
+		std::size_t const count = 100000;
+
+		Philox4x32 rng( 42 );
+		std::vector<float> values( count );
+		rng.fill_normal( count, values.data(), 3.f, 2.f );
+
+		double mean = 0.;
+		for( auto const v : values )
+			mean += v;
+		mean /= count;
+
+		double variance = 0.;
+		for( auto const v : values )
+			variance += (v - mean) * (v - mean);
+		variance /= count;
+
+		REQUIRE( std::abs( mean - 3. ) < 0.05 );
+		REQUIRE( std::abs( std::sqrt( variance ) - 2. ) < 0.05 );
+	}
+}
@@ -1,11 +1,12 @@
 #include "asteroid.hpp"
 
 #include <random>
-#include <vector>
+#include <utility>
 #include <algorithm>
 
 #include <cmath>
 #include <cassert>
+#include <cstdint>
 
 #include "../draw2d/shape.hpp"
 
@@ -18,9 +19,17 @@ namespace
 	// https://en.cppreference.com/w/cpp/numeric/constants
 	// This defines a custom (worse) one:
 	constexpr float kPI = 3.1415926535897932385f; // pi
+
+	struct Decimated_
+	{
+		std::uint64_t rimMask;
+		float error; // Largest distance of a dropped vertex to the outline
+	};
+
+	Decimated_ decimate_( Vec2f const* aRim, Decimated_ aFrom, std::size_t aKeep );
 }
 
-TriangleFan make_asteroid( std::minstd_rand& aRNG, std::size_t aNumPoints, float aRadiusMean, float aRadiusStddev, float aSquishStddev, float aDisplaceStddev, ColorF const& aBaseColor, float aColorBaseStddev, float aColorVar )
+TriangleFan make_asteroid( RNG& aRNG, std::size_t aNumPoints, float aRadiusMean, float aRadiusStddev, float aSquishStddev, float aDisplaceStddev, ColorF const& aBaseColor, float aColorBaseStddev, float aColorVar )
 {
 	// Sample general parameters
 	float const radius = std::normal_distribution<float>{aRadiusMean, aRadiusStddev}(aRNG);
@@ -33,13 +42,17 @@ TriangleFan make_asteroid( std::minstd_rand& aRNG, std::size_t aNumPoints, float
 	baseColor.g = std::clamp( baseColor.g + crand, 0.1f, 1.f );
 	baseColor.b = std::clamp( baseColor.b + crand, 0.1f, 1.f );
 
+	// The fan's vertex data is written in place: the center goes to index 0,
+	// the N points around it to indices 1 to N. (For the default parameters,
+	// the storage is inline and this allocates nothing.)
+	TriangleFan::Storage storage( aNumPoints+1 );
+
+	Vec2f* const verts = storage.vertices() + 1;
+	ColorF* const colors = storage.colors() + 1;
+
 	// Generate initial circle
 	float const astep = 2.f*kPI / aNumPoints;
 
-	std::vector<Vec2f> verts;
-	verts.reserve( aNumPoints+1 );
-	verts.resize( aNumPoints );
-
 	for( std::size_t i = 0; i < aNumPoints; ++i )
 	{
 		verts[i] = radius * Vec2f{
@@ -50,8 +63,10 @@ TriangleFan make_asteroid( std::minstd_rand& aRNG, std::size_t aNumPoints, float
 
 	// Displace vertices
 	std::normal_distribution<float> displace( 0.f, aDisplaceStddev );
-	for( auto& vert : verts )
+	for( std::size_t i = 0; i < aNumPoints; ++i )
 	{
+		auto& vert = verts[i];
+
 		float const displacement = displace( aRNG );
 		float const length = std::sqrt( dot( vert, vert ) );
 		Vec2f const delta = (displacement / length) * vert;
@@ -62,14 +77,12 @@ TriangleFan make_asteroid( std::minstd_rand& aRNG, std::size_t aNumPoints, float
 	// Squish
 	// We only need to squish along one axis to make the shape less round. The
 	// asteroids are rotated randomly later.
-	for( auto& vert : verts )
-		vert.x *= squish;
+	for( std::size_t i = 0; i < aNumPoints; ++i )
+		verts[i].x *= squish;
 
 	// Generate colors
 	std::uniform_real_distribution<float> cdist( -aColorVar, aColorVar );
 
-	std::vector<ColorF> colors;
-	colors.reserve( aNumPoints + 1 );
 	for( std::size_t i = 0; i < aNumPoints; ++i )
 	{
 		float cvar = cdist(aRNG);
@@ -79,14 +92,111 @@ TriangleFan make_asteroid( std::minstd_rand& aRNG, std::size_t aNumPoints, float
 		col.g = std::clamp( col.g + cvar, 0.f, 1.f );
 		col.b = std::clamp( col.b + cvar, 0.f, 1.f );
 
-		colors.emplace_back( col );
+		colors[i] = col;
 	}
 
 	// Complete shape
-	verts.emplace( verts.begin(), Vec2f{ 0.f, 0.f } );
-	colors.emplace( colors.begin(), baseColor );
+	storage.vertices()[0] = Vec2f{ 0.f, 0.f };
+	storage.colors()[0] = baseColor;
+
+	// Levels of detail. Each level drops about a quarter of the previous
+	// level's rim vertices. A level is used while its approximate error,
+	// projected to the screen, stays below the random displacement of the rim
+	// vertices: the decimated outline is then as plausible as the original
+	// one. (A sub-pixel budget would never apply, as the rim vertices are
+	// only a few pixels apart at the sizes that asteroids are drawn at.)
+	// Asteroids are not zoomed, so each asteroid keeps its level and there
+	// is no popping between levels.
+	TriangleFan::Lod lods[TriangleFan::kMaxLods];
+	std::size_t lodCount = 0;
+
+	if( aNumPoints <= 64 )
+	{
+		// Same as TriangleFan::bounding_radius(); the center is at the origin.
+		float boundingRadius = 0.f;
+		for( std::size_t i = 0; i < aNumPoints; ++i )
+			boundingRadius = std::max( boundingRadius, std::sqrt( dot( verts[i], verts[i] ) ) );
+
+		std::size_t kept = aNumPoints;
+		Decimated_ level{ aNumPoints < 64 ? (std::uint64_t(1) << aNumPoints) - 1 : ~std::uint64_t(0), 0.f };
+
+		std::size_t const kMinKept[TriangleFan::kMaxLods] = { 6, 5, 4 };
+		for( std::size_t i = 0; i < TriangleFan::kMaxLods; ++i )
+		{
+			std::size_t const keep = std::max( kept*3 / 4, kMinKept[i] );
+			if( keep >= kept )
+				break;
+
+			level = decimate_( verts, level, keep );
+			kept = keep;
+
+			if( level.error <= 0.f )
+				continue;
+
+			lods[lodCount++] = TriangleFan::Lod{
+				level.rimMask,
+				aDisplaceStddev * boundingRadius / level.error
+			};
+		}
+	}
+
+	TriangleFan fan( std::move(storage) );
+	fan.set_lods( lodCount, lods );
+	return fan;
+}
 
-	// Return shape
-	// We could be a bit more clever here and avoid the double allocations...
-	return TriangleFan( verts.size(), verts.data(), colors.data() );
+namespace
+{
+	Decimated_ decimate_( Vec2f const* aRim, Decimated_ aFrom, std::size_t aKeep )
+	{
+		// Greedy: repeatedly drop the vertex that spans the smallest triangle
+		// with its two neighbours, i.e., the one whose removal changes the
+		// outline the least.
+		std::size_t indices[64];
+		std::size_t count = 0;
+		for( std::size_t i = 0; i < 64; ++i )
+		{
+			if( aFrom.rimMask & (std::uint64_t(1) << i) )
+				indices[count++] = i;
+		}
+
+		float error = aFrom.error;
+		while( count > aKeep )
+		{
+			std::size_t best = 0;
+			float bestArea = 0.f, bestBase = 1.f;
+			for( std::size_t j = 0; j < count; ++j )
+			{
+				Vec2f const prev = aRim[indices[(j+count-1) % count]];
+				Vec2f const curr = aRim[indices[j]];
+				Vec2f const next = aRim[indices[(j+1) % count]];
+
+				Vec2f const base = next - prev;
+				Vec2f const side = curr - prev;
+				float const area = std::abs( base.x*side.y - base.y*side.x );
+
+				if( 0 == j || area < bestArea )
+				{
+					best = j;
+					bestArea = area;
+					bestBase = std::sqrt( dot( base, base ) );
+				}
+			}
+
+			// Distance of the dropped vertex to the new edge. Errors of
+			// earlier drops are not re-measured against the new outline, so
+			// this is an estimate.
+			if( bestBase > 0.f )
+				error = std::max( error, bestArea / bestBase );
+
+			std::copy( indices+best+1, indices+count, indices+best );
+			--count;
+		}
+
+		Decimated_ ret{ 0, error };
+		for( std::size_t j = 0; j < count; ++j )
+			ret.rimMask |= std::uint64_t(1) << indices[j];
+
+		return ret;
+	}
 }
@@ -17,6 +17,13 @@
  * Each asteroid is represented by a triangle fan. This limits the possible
  * shapes to deformed circles where lines going from the mid point to the
  * periphery cannot pass outside of the shape.
+ *
+ * The fan gets up to TriangleFan::kMaxLods levels of detail, made by greedily
+ * dropping the rim vertices that contribute the least area to the outline
+ * (each level keeps about three quarters of the previous one's vertices). A
+ * level is used while its estimated error, projected to the screen, stays
+ * below the rim displacement (aDisplaceStddev). Asteroids with more than 64
+ * points have no levels of detail.
  */
 
 #if 1
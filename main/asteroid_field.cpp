@@ -1,24 +1,50 @@
 #include "asteroid_field.hpp"
 
+#include <cmath>
 #include <random>
 #include <algorithm>
 
 #include <cassert>
 
 #include "../draw2d/shape.hpp"
+#include "../draw2d/surface.hpp"
 
 #include "asteroid.hpp"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define MAIN_ASTEROID_FIELD_SSE2 1
+#	include <emmintrin.h>
+#endif
+
 namespace
 {
 	// C++20 adds a number of standardized mathematical constants:
 	// https://en.cppreference.com/w/cpp/numeric/constants
 	// This defines a custom (worse) one:
 	constexpr float kPI = 3.1415926535897932385f; // pi
+
+	// Variation between instances of the same prototype
+	constexpr float kScaleStddev = 0.1f;
+	constexpr float kScaleMin = 0.7f, kScaleMax = 1.3f;
+
+	constexpr float kTintStddev = 0.15f;
+	constexpr float kTintMin = 0.6f, kTintMax = 1.4f;
+
+	// Respawn parameter pool (see AsteroidField::Launch_)
+	constexpr std::size_t kLaunchPoolSize = 256;
+	constexpr std::size_t kLaunchRefillPerUpdate = 16;
+
+	bool inside_polygon_( Vec2f, std::size_t aCount, Vec2f const* aPolygon ) noexcept;
+
+	// Scales the velocity down to at most aMaxSpeed, keeping its direction
+	void limit_speed_( float& aVelX, float& aVelY, float aMaxSpeed ) noexcept;
 }
 
-AsteroidField::AsteroidField( RNG& aRNG, std::uint32_t aWidth, std::uint32_t aHeight, float aDensity, float aInitialSpeedStddev, float aMaximumSpeed, float aInitialRotStddev, float aPadding )
-	: mInitialSpeed( aInitialSpeedStddev )
+AsteroidField::AsteroidField( RNG aRNG, std::uint32_t aWidth, std::uint32_t aHeight, float aDensity, float aInitialSpeedStddev, float aMaximumSpeed, float aInitialRotStddev, float aPadding, std::size_t aPrototypeCount )
+	: mMaxRadius( 0.f )
+	, mGrid( 1.f )
+	, mLastElapsed( 0.f )
+	, mInitialSpeed( aInitialSpeedStddev )
 	, mMaximumSpeed( aMaximumSpeed )
 	, mInitialRot( aInitialRotStddev )
 	, mPadding( aPadding )
@@ -36,37 +62,37 @@ AsteroidField::AsteroidField( RNG& aRNG, std::uint32_t aWidth, std::uint32_t aHe
 	// Generate initial asteroids
 	float const numAsteroidsf = mActualExtent.x*mActualExtent.y * mDensity;
 	std::size_t const numAsteroids = std::size_t(numAsteroidsf+0.5f);
-	
-	mAsteroids.resize( numAsteroids );
-	mShapes.reserve( numAsteroids ); // reserve! not resize!
 
-	using Uniform_ = std::uniform_real_distribution<float>;
-	using Normal_ = std::normal_distribution<float>;
+	// Generate the shape library
+	assert( aPrototypeCount > 0 );
+
+	mPrototypes.reserve( aPrototypeCount ); // reserve! not resize!
+	for( std::size_t i = 0; i < aPrototypeCount; ++i )
+	{
+		mPrototypes.emplace_back( make_asteroid( mRNG ) );
+		mMaxRadius = std::max( mMaxRadius, mPrototypes.back().bounding_radius() * kScaleMax );
+	}
 
-	Uniform_ xpos{ mBoundsMin.x, mBoundsMax.x };
-	Uniform_ ypos{ mBoundsMin.y, mBoundsMax.y };
+	// With cells twice the largest radius, a query for overlaps with an
+	// asteroid only visits the 3x3 cells around it.
+	mGrid = SpatialGrid( std::max( 2.f*mMaxRadius, 1.f ) );
 
-	Uniform_ angle( 0.f, 2*kPI );
+	mAsteroids.resize( numAsteroids );
 
-	Normal_ vvel{ 0.f, mInitialSpeed };
-	Normal_ rots{ 0.f, mInitialRot };
+	mRNG.fill_uniform( numAsteroids, mAsteroids.posX.data(), mBoundsMin.x, mBoundsMax.x );
+	mRNG.fill_uniform( numAsteroids, mAsteroids.posY.data(), mBoundsMin.y, mBoundsMax.y );
 
 	for( std::size_t i = 0; i < numAsteroids; ++i )
-	{
-		auto& astr = mAsteroids[i];
-		astr.pos = Vec2f{ xpos( mRNG ), ypos( mRNG ) };
-		astr.vel = Vec2f{ vvel( mRNG ), vvel( mRNG ) };
+		launch_( i );
 
-		astr.rot = make_rotation_2d( angle( mRNG ) );
-		astr.radpersec = rots( mRNG );
+	// Fill the respawn pool
+	mLaunchPool.reserve( kLaunchPoolSize );
+	sample_launches_( kLaunchPoolSize - mLaunchPool.size() );
 
-		// Don't break the speed limits. The space police will get you!
-		astr.vel.x = std::clamp( astr.vel.x, -mMaximumSpeed, +mMaximumSpeed );
-		astr.vel.y = std::clamp( astr.vel.y, -mMaximumSpeed, +mMaximumSpeed );
+	mAsteroids.prevX = mAsteroids.posX;
+	mAsteroids.prevY = mAsteroids.posY;
 
-		// Create shape
-		mShapes.emplace_back( make_asteroid( mRNG ) );
-	}
+	rebuild_grid_();
 }
 
 AsteroidField::~AsteroidField() = default;
@@ -74,93 +100,180 @@ AsteroidField::~AsteroidField() = default;
 
 void AsteroidField::update( float aElapsed, Vec2f const& aTransl )
 {
-	auto const numAsteroids = mAsteroids.size();
-	assert( numAsteroids == mShapes.size() );
+	// Remember the previous state for draw()
+	mAsteroids.prevX = mAsteroids.posX;
+	mAsteroids.prevY = mAsteroids.posY;
+	mLastElapsed = aElapsed;
 
-	using Uniform_ = std::uniform_real_distribution<float>;
-	using Normal_ = std::normal_distribution<float>;
+	// Resolve collisions first, such that all asteroids end up within the
+	// simulation area (or are respawned) when the update completes.
+	collide_();
 
-	Uniform_ xpos{ mBoundsMin.x, mBoundsMax.x };
-	Uniform_ ypos{ mBoundsMin.y, mBoundsMax.y };
+	auto const numAsteroids = mAsteroids.size();
 
-	Uniform_ angle( 0.f, 2*kPI );
+	float* const posX = mAsteroids.posX.data();
+	float* const posY = mAsteroids.posY.data();
+	float const* const velX = mAsteroids.velX.data();
+	float const* const velY = mAsteroids.velY.data();
+	float* const angle = mAsteroids.angle.data();
+	float const* const radpersec = mAsteroids.radpersec.data();
+
+	// Move and rotate all asteroids. Asteroids that end up outside of the
+	// simulation area are collected in mRespawns (without branching) and
+	// handled afterwards. The angles are kept in [0, 2pi); this assumes that
+	// no asteroid rotates by more than a full turn per update.
+	mRespawns.resize( numAsteroids );
+	std::uint32_t* const respawns = mRespawns.data();
+
+	float const twoPi = 2.f*kPI;
+
+	std::size_t respawnCount = 0;
+	std::size_t i = 0;
+
+#	if defined(MAIN_ASTEROID_FIELD_SSE2)
+	__m128 const dt = _mm_set1_ps( aElapsed );
+	__m128 const translX = _mm_set1_ps( aTransl.x );
+	__m128 const translY = _mm_set1_ps( aTransl.y );
+	__m128 const minX = _mm_set1_ps( mBoundsMin.x );
+	__m128 const minY = _mm_set1_ps( mBoundsMin.y );
+	__m128 const maxX = _mm_set1_ps( mBoundsMax.x );
+	__m128 const maxY = _mm_set1_ps( mBoundsMax.y );
+	__m128 const fullTurn = _mm_set1_ps( twoPi );
+	__m128 const zero = _mm_setzero_ps();
+
+	for( ; i+4 <= numAsteroids; i += 4 )
+	{
+		__m128 const x = _mm_sub_ps( _mm_add_ps( _mm_loadu_ps( posX+i ), _mm_mul_ps( _mm_loadu_ps( velX+i ), dt ) ), translX );
+		__m128 const y = _mm_sub_ps( _mm_add_ps( _mm_loadu_ps( posY+i ), _mm_mul_ps( _mm_loadu_ps( velY+i ), dt ) ), translY );
+		_mm_storeu_ps( posX+i, x );
+		_mm_storeu_ps( posY+i, y );
+
+		__m128 a = _mm_add_ps( _mm_loadu_ps( angle+i ), _mm_mul_ps( _mm_loadu_ps( radpersec+i ), dt ) );
+		a = _mm_sub_ps( a, _mm_and_ps( _mm_cmpge_ps( a, fullTurn ), fullTurn ) );
+		a = _mm_add_ps( a, _mm_and_ps( _mm_cmplt_ps( a, zero ), fullTurn ) );
+		_mm_storeu_ps( angle+i, a );
+
+		__m128 const outside = _mm_or_ps(
+			_mm_or_ps( _mm_cmplt_ps( x, minX ), _mm_cmpgt_ps( x, maxX ) ),
+			_mm_or_ps( _mm_cmplt_ps( y, minY ), _mm_cmpgt_ps( y, maxY ) )
+		);
 
-	Normal_ vvel{ 0.f, mInitialSpeed };
-	Normal_ rots{ 0.f, mInitialRot };
+		int const mask = _mm_movemask_ps( outside );
+		for( int lane = 0; lane < 4; ++lane )
+		{
+			respawns[respawnCount] = std::uint32_t(i + lane);
+			respawnCount += (mask >> lane) & 1;
+		}
+	}
+#	endif // ~ SSE2
 
-	for( std::size_t i = 0; i < numAsteroids; ++i )
+	for( ; i < numAsteroids; ++i )
 	{
-		auto& astr = mAsteroids[i];
-		astr.pos += astr.vel * aElapsed - aTransl;
-
-		// If the asteroid is outside of the simulation area, replace it
-		// with a fresh one.
-		//
-		// The method here isn't entirely optimal. The density of asteroids on
-		// screen will reduce slightly over time (until some minimum) if the
-		// player is standing still. New asteroids are generated with random
-		// movement vectors. The random vectors are picked uniformly, meaning
-		// that the asteroid has a fair chance to move off-screen without ever
-		// becoming visible.
-		if( astr.pos.x < mBoundsMin.x || astr.pos.x > mBoundsMax.x || astr.pos.y < mBoundsMin.y || astr.pos.y > mBoundsMax.x )
-		{
-			if( astr.pos.x < mBoundsMin.x )
-			{
-				astr.pos.x = mBoundsMax.x - mPadding/2.f;
-				astr.pos.y = ypos( mRNG );
-			}
-			else if( astr.pos.x > mBoundsMax.x )
-			{
-				astr.pos.x = mBoundsMin.x + mPadding/2.f;
-				astr.pos.y = ypos( mRNG );
-			}
-			else if( astr.pos.y < mBoundsMin.y )
-			{
-				astr.pos.x = xpos( mRNG );
-				astr.pos.y = mBoundsMax.y - mPadding/2.f;
-			}
-			else if( astr.pos.y > mBoundsMax.y )
-			{
-				astr.pos.x = xpos( mRNG );
-				astr.pos.y = mBoundsMin.y + mPadding/2.f;
-			}
+		float const x = posX[i] + velX[i] * aElapsed - aTransl.x;
+		float const y = posY[i] + velY[i] * aElapsed - aTransl.y;
+		posX[i] = x;
+		posY[i] = y;
 
-			astr.vel = Vec2f{ vvel( mRNG ), vvel( mRNG ) };
+		float a = angle[i] + radpersec[i] * aElapsed;
+		a -= (a >= twoPi) ? twoPi : 0.f;
+		a += (a < 0.f) ? twoPi : 0.f;
+		angle[i] = a;
 
-			astr.rot = make_rotation_2d( angle( mRNG ) );
-			astr.radpersec = rots( mRNG );
+		bool const outside = (x < mBoundsMin.x) | (x > mBoundsMax.x) | (y < mBoundsMin.y) | (y > mBoundsMax.y);
 
-			// Don't break the speed limits. The space police will get you!
-			astr.vel.x = std::clamp( astr.vel.x, -mMaximumSpeed, +mMaximumSpeed );
-			astr.vel.y = std::clamp( astr.vel.y, -mMaximumSpeed, +mMaximumSpeed );
+		respawns[respawnCount] = std::uint32_t(i);
+		respawnCount += outside;
+	}
+
+	// If the asteroid is outside of the simulation area, replace it
+	// with a fresh one.
+	//
+	// The method here isn't entirely optimal. The density of asteroids on
+	// screen will reduce slightly over time (until some minimum) if the
+	// player is standing still. New asteroids are generated with random
+	// movement vectors. The random vectors are picked uniformly, meaning
+	// that the asteroid has a fair chance to move off-screen without ever
+	// becoming visible.
+	//
+	// Each respawn needs one random coordinate; these are drawn in bulk.
+	// Make sure the pool holds a launch for every respawn first: launch_()
+	// would otherwise sample a new batch, overwriting mRandom mid-loop.
+	if( mLaunchPool.size() < respawnCount )
+		sample_launches_( respawnCount - mLaunchPool.size() );
+
+	mRandom.resize( respawnCount );
+	mRNG.fill_uniform( respawnCount, mRandom.data() );
+
+	for( std::size_t j = 0; j < respawnCount; ++j )
+	{
+		auto const idx = respawns[j];
+		assert( !mLaunchPool.empty() );
+		float const u = mRandom[j];
 
-			// Create shape
-			mShapes[i] = make_asteroid( mRNG );
+		if( posX[idx] < mBoundsMin.x )
+		{
+			posX[idx] = mBoundsMax.x - mPadding/2.f;
+			posY[idx] = mBoundsMin.y + u * mActualExtent.y;
+		}
+		else if( posX[idx] > mBoundsMax.x )
+		{
+			posX[idx] = mBoundsMin.x + mPadding/2.f;
+			posY[idx] = mBoundsMin.y + u * mActualExtent.y;
+		}
+		else if( posY[idx] < mBoundsMin.y )
+		{
+			posX[idx] = mBoundsMin.x + u * mActualExtent.x;
+			posY[idx] = mBoundsMax.y - mPadding/2.f;
 		}
 		else
 		{
-			astr.rot = make_rotation_2d( astr.radpersec * aElapsed ) * astr.rot;
+			assert( posY[idx] > mBoundsMax.y );
+			posX[idx] = mBoundsMin.x + u * mActualExtent.x;
+			posY[idx] = mBoundsMin.y + mPadding/2.f;
 		}
+
+		// No interpolation across the jump
+		mAsteroids.prevX[idx] = posX[idx];
+		mAsteroids.prevY[idx] = posY[idx];
+
+		launch_( idx );
 	}
+
+	// Top up the respawn pool. Only a fixed number of entries per update, so
+	// that a burst of respawns does not turn into a burst of sampling.
+	if( mLaunchPool.size() < kLaunchPoolSize )
+		sample_launches_( std::min( kLaunchRefillPerUpdate, kLaunchPoolSize - mLaunchPool.size() ) );
+
+	rebuild_grid_();
 }
 
-void AsteroidField::draw( Surface& aSurface ) const
+void AsteroidField::draw( Surface& aSurface, float aAlpha ) const
 {
-	auto const numAsteroids = mAsteroids.size();
-	assert( numAsteroids == mShapes.size() );
+	float const width = float(aSurface.get_width());
+	float const height = float(aSurface.get_height());
 
-	for( std::size_t i = 0; i < numAsteroids; ++i )
+	for( std::size_t i = 0; i < mAsteroids.size(); ++i )
 	{
-		auto const& astr = mAsteroids[i];
-		auto const& shape = mShapes[i];
+		assert( mAsteroids.prototype[i] < mPrototypes.size() );
+		auto const& shape = mPrototypes[mAsteroids.prototype[i]];
+
+		float const scale = mAsteroids.scale[i];
+
+		Vec2f const prev{ mAsteroids.prevX[i], mAsteroids.prevY[i] };
+		Vec2f const pos = prev + aAlpha * (Vec2f{ mAsteroids.posX[i], mAsteroids.posY[i] } - prev);
 
-		// Performance: culling asteroids here would remove some work; right
-		// now each triangle will be culled individually.
+		// Asteroids outside of the view are culled by TriangleFan::draw()
+		// with a single bounding circle test. Do the same test here first,
+		// to skip building the rotation matrix (sin/cos) as well.
+		float const radius = mAsteroids.radius[i] + 1.f;
+		if( pos.x + radius < 0.f || pos.x - radius > width || pos.y + radius < 0.f || pos.y - radius > height )
+			continue;
 
 		shape.draw(
 			aSurface,
-			astr.rot,
-			astr.pos
+			Mat22f{ scale, 0.f, 0.f, scale } * make_rotation_2d( mAsteroids.angle[i] - (1.f-aAlpha) * mAsteroids.radpersec[i] * mLastElapsed ),
+			pos,
+			mAsteroids.tint[i]
 		);
 	}
 }
@@ -182,37 +295,25 @@ void AsteroidField::resize( std::uint32_t aWidth, std::uint32_t aHeight )
 	float const numAsteroidsf = mActualExtent.x*mActualExtent.y * mDensity;
 	std::size_t const numAsteroids = std::size_t(numAsteroidsf+0.5f);
 
-	// Remove asteroids now outside
+	// Remove asteroids now outside. Remaining asteroids are compacted in a
+	// single pass (keeping their order).
 	std::size_t activeAsteroids = 0;
 
-	auto jt = mShapes.begin();
-	for( auto it = mAsteroids.begin(); it != mAsteroids.end(); )
+	for( std::size_t i = 0; i < mAsteroids.size(); ++i )
 	{
-		auto const& aster = *it;
+		if( mAsteroids.posX[i] > mBoundsMax.x || mAsteroids.posY[i] > mBoundsMax.y )
+			continue;
 
-		if( aster.pos.x > mBoundsMax.x || aster.pos.y > mBoundsMax.y )
-		{
-			it = mAsteroids.erase( it );
-			jt = mShapes.erase( jt );
-		}
-		else
-		{
-			++it;
-			++jt;
-			++activeAsteroids;
-		}
+		if( i != activeAsteroids )
+			mAsteroids.move( activeAsteroids, i );
+
+		++activeAsteroids;
 	}
 
 	mAsteroids.resize( numAsteroids );
 	activeAsteroids = std::min( activeAsteroids, numAsteroids );
 
-	mShapes.erase( mShapes.begin()+activeAsteroids, mShapes.end() );
-	mShapes.reserve( numAsteroids );
-
-	assert( mShapes.size() == activeAsteroids );
-
 	// Generate new asteroids.
-	using Normal_ = std::normal_distribution<float>;
 	using Uniform_ = std::uniform_real_distribution<float>;
 
 	if( activeAsteroids < numAsteroids )
@@ -230,11 +331,6 @@ void AsteroidField::resize( std::uint32_t aWidth, std::uint32_t aHeight )
 		Uniform_ yax( 0.f, mBoundsMax.x - dd.x );
 		Uniform_ yay( oldMax.y, oldMax.y+dd.y );
 
-		Uniform_ angle( 0.f, 2*kPI );
-
-		Normal_ vvel{ 0.f, mInitialSpeed };
-		Normal_ rots{ 0.f, mInitialRot };
-
 		for( std::size_t i = activeAsteroids; i < numAsteroids; ++i )
 		{
 			Vec2f pos;
@@ -251,24 +347,425 @@ void AsteroidField::resize( std::uint32_t aWidth, std::uint32_t aHeight )
 				pos.y = yay( mRNG );
 			}
 
-			auto& astr = mAsteroids[i];
+			mAsteroids.posX[i] = pos.x;
+			mAsteroids.posY[i] = pos.y;
 
-			astr.pos = pos;
-			astr.vel = Vec2f{ vvel( mRNG ), vvel( mRNG ) };
+			launch_( i );
+		}
+	}
 
-			astr.rot = make_rotation_2d( angle( mRNG ) );
-			astr.radpersec = rots( mRNG );
+	// No interpolation across a resize
+	mAsteroids.prevX = mAsteroids.posX;
+	mAsteroids.prevY = mAsteroids.posY;
 
-			// Don't break the speed limits. The space police will get you!
-			astr.vel.x = std::clamp( astr.vel.x, -mMaximumSpeed, +mMaximumSpeed );
-			astr.vel.y = std::clamp( astr.vel.y, -mMaximumSpeed, +mMaximumSpeed );
+	rebuild_grid_();
+}
 
-			// Create shape
-			assert( i == mShapes.size() );
-			mShapes.emplace_back( make_asteroid( mRNG ) );
-		}
+void AsteroidField::query_radius( Vec2f aCenter, float aRadius, std::vector<std::uint32_t>& aOut ) const
+{
+	// The grid only knows the centers; grow the query by the largest radius,
+	// then test the candidates with their own radius.
+	auto const first = aOut.size();
+	mGrid.query_radius( aCenter, aRadius + mMaxRadius, aOut );
+
+	auto const last = std::remove_if( aOut.begin()+first, aOut.end(), [&] (std::uint32_t aIdx) {
+		Vec2f const d = get_position( aIdx ) - aCenter;
+		float const reach = aRadius + get_radius( aIdx );
+		return dot( d, d ) > reach*reach;
+	} );
+	aOut.erase( last, aOut.end() );
+}
+
+void AsteroidField::query_aabb( Vec2f aMin, Vec2f aMax, std::vector<std::uint32_t>& aOut ) const
+{
+	auto const first = aOut.size();
+	mGrid.query_aabb( aMin - Vec2f{ mMaxRadius, mMaxRadius }, aMax + Vec2f{ mMaxRadius, mMaxRadius }, aOut );
+
+	auto const last = std::remove_if( aOut.begin()+first, aOut.end(), [&] (std::uint32_t aIdx) {
+		// Distance from the center to the closest point of the rectangle
+		Vec2f const pos = get_position( aIdx );
+		Vec2f const d = pos - Vec2f{ std::clamp( pos.x, aMin.x, aMax.x ), std::clamp( pos.y, aMin.y, aMax.y ) };
+		float const radius = get_radius( aIdx );
+		return dot( d, d ) > radius*radius;
+	} );
+	aOut.erase( last, aOut.end() );
+}
+
+void AsteroidField::query_line_strip( LineStrip const& aStrip, Mat22f const& aTransform, Vec2f const& aTranslation, std::vector<std::uint32_t>& aOut ) const
+{
+	auto const count = aStrip.vertex_count();
+	if( 0 == count )
+		return;
+
+	// Transform the strip once. Its bounding circle is centered on the
+	// translation.
+	thread_local std::vector<Vec2f> world, local;
+	world.resize( count );
+	local.resize( count );
+
+	float radiusSquared = 0.f;
+	for( std::size_t i = 0; i < count; ++i )
+	{
+		world[i] = aTransform * aStrip.vertices()[i] + aTranslation;
+
+		Vec2f const d = world[i] - aTranslation;
+		radiusSquared = std::max( radiusSquared, dot( d, d ) );
 	}
 
-	assert( mAsteroids.size() == mShapes.size() );
+	bool const closed = count > 2 && world[0].x == world[count-1].x && world[0].y == world[count-1].y;
+
+	// Broad phase
+	auto const first = aOut.size();
+	query_radius( aTranslation, std::sqrt( radiusSquared ), aOut );
+
+	// Narrow phase. Rather than transforming the fan, bring the strip into
+	// the asteroid's local space (i.e., undo its translation, rotation and
+	// scale).
+	auto const last = std::remove_if( aOut.begin()+first, aOut.end(), [&] (std::uint32_t aIdx) {
+		Vec2f const pos = get_position( aIdx );
+		auto const& shape = mPrototypes[mAsteroids.prototype[aIdx]];
+
+		if( closed && inside_polygon_( pos, count, world.data() ) )
+			return false;
+
+		float const angle = mAsteroids.angle[aIdx];
+		float const invScale = 1.f / mAsteroids.scale[aIdx];
+		Mat22f const toLocal = Mat22f{ invScale, 0.f, 0.f, invScale } * make_rotation_2d( -angle );
+
+		for( std::size_t i = 0; i < count; ++i )
+			local[i] = toLocal * (world[i] - pos);
+
+		return !detail::outline_hits_fan( count, local.data(), shape.vertex_count(), shape.vertices() );
+	} );
+	aOut.erase( last, aOut.end() );
+}
+
+Vec2f AsteroidField::get_position( std::size_t aIndex ) const noexcept
+{
+	assert( aIndex < mAsteroids.size() );
+	return Vec2f{ mAsteroids.posX[aIndex], mAsteroids.posY[aIndex] };
 }
 
+float AsteroidField::get_radius( std::size_t aIndex ) const noexcept
+{
+	assert( aIndex < mAsteroids.size() );
+	return mAsteroids.radius[aIndex];
+}
+
+std::size_t AsteroidField::prototype_count() const noexcept
+{
+	return mPrototypes.size();
+}
+TriangleFan const& AsteroidField::get_prototype( std::uint32_t aPrototype ) const noexcept
+{
+	assert( aPrototype < mPrototypes.size() );
+	return mPrototypes[aPrototype];
+}
+
+AsteroidField::State AsteroidField::get_state( std::size_t aIndex ) const noexcept
+{
+	assert( aIndex < mAsteroids.size() );
+
+	State state;
+	state.position = Vec2f{ mAsteroids.posX[aIndex], mAsteroids.posY[aIndex] };
+	state.velocity = Vec2f{ mAsteroids.velX[aIndex], mAsteroids.velY[aIndex] };
+	state.angle = mAsteroids.angle[aIndex];
+	state.radpersec = mAsteroids.radpersec[aIndex];
+	state.prototype = mAsteroids.prototype[aIndex];
+	state.scale = mAsteroids.scale[aIndex];
+	state.tint = mAsteroids.tint[aIndex];
+	return state;
+}
+
+void AsteroidField::set_state( std::size_t aIndex, State const& aState )
+{
+	assert( aIndex < mAsteroids.size() );
+	assert( aState.prototype < mPrototypes.size() );
+
+	mAsteroids.posX[aIndex] = mAsteroids.prevX[aIndex] = aState.position.x;
+	mAsteroids.posY[aIndex] = mAsteroids.prevY[aIndex] = aState.position.y;
+	mAsteroids.velX[aIndex] = aState.velocity.x;
+	mAsteroids.velY[aIndex] = aState.velocity.y;
+	mAsteroids.angle[aIndex] = aState.angle;
+	mAsteroids.radpersec[aIndex] = aState.radpersec;
+	mAsteroids.prototype[aIndex] = aState.prototype;
+	mAsteroids.scale[aIndex] = aState.scale;
+	mAsteroids.tint[aIndex] = aState.tint;
+
+	mAsteroids.radius[aIndex] = mPrototypes[aState.prototype].bounding_radius() * aState.scale;
+
+	// The queries rely on mMaxRadius; scales outside of the usual range
+	// must not break them.
+	mMaxRadius = std::max( mMaxRadius, mAsteroids.radius[aIndex] );
+
+	rebuild_grid_();
+}
+
+void AsteroidField::launch_( std::size_t aIndex )
+{
+	// Sample directly only if the pool has run dry.
+	if( mLaunchPool.empty() )
+		sample_launches_( kLaunchRefillPerUpdate );
+
+	Launch_ const launch = mLaunchPool.back();
+	mLaunchPool.pop_back();
+
+	mAsteroids.velX[aIndex] = launch.velX;
+	mAsteroids.velY[aIndex] = launch.velY;
+	mAsteroids.angle[aIndex] = launch.angle;
+	mAsteroids.radpersec[aIndex] = launch.radpersec;
+	mAsteroids.prototype[aIndex] = launch.prototype;
+	mAsteroids.scale[aIndex] = launch.scale;
+	mAsteroids.tint[aIndex] = launch.tint;
+
+	mAsteroids.radius[aIndex] = mPrototypes[launch.prototype].bounding_radius() * launch.scale;
+}
+
+void AsteroidField::sample_launches_( std::size_t aCount )
+{
+	// Draw the random numbers for the whole batch at once: five normally
+	// distributed and two uniform ones per launch.
+	mRandom.resize( 7*aCount );
+
+	float* const normal = mRandom.data();
+	float* const uniform = normal + 5*aCount;
+
+	mRNG.fill_normal( 5*aCount, normal );
+	mRNG.fill_uniform( 2*aCount, uniform );
+
+	auto const protoCount = std::uint32_t(mPrototypes.size());
+
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		float const* const n = normal + 5*i;
+		float const* const u = uniform + 2*i;
+
+		Launch_ launch;
+
+		// Don't break the speed limits. The space police will get you!
+		launch.velX = std::clamp( n[0] * mInitialSpeed, -mMaximumSpeed, +mMaximumSpeed );
+		launch.velY = std::clamp( n[1] * mInitialSpeed, -mMaximumSpeed, +mMaximumSpeed );
+
+		launch.angle = u[0] * 2*kPI;
+		launch.radpersec = n[2] * mInitialRot;
+
+		launch.prototype = std::min( std::uint32_t(u[1] * float(protoCount)), protoCount-1 );
+		launch.scale = std::clamp( 1.f + n[3] * kScaleStddev, kScaleMin, kScaleMax );
+
+		// Uniform brightness change; the prototypes already vary in color.
+		float const brightness = std::clamp( 1.f + n[4] * kTintStddev, kTintMin, kTintMax );
+		launch.tint = ColorF{ brightness, brightness, brightness };
+
+		mLaunchPool.emplace_back( launch );
+	}
+}
+
+
+void AsteroidField::collide_()
+{
+	// Pairs whose bounding boxes overlap. The sweep works on its own copy of
+	// the positions, so resolving the pairs afterwards (in the order that the
+	// sweep found them) is the same as resolving them during the sweep.
+	mSweep.find_pairs(
+		mAsteroids.size(),
+		mAsteroids.posX.data(), mAsteroids.posY.data(), mAsteroids.radius.data(),
+		mCollisionPairs
+	);
+
+	for( auto const& pair : mCollisionPairs )
+		resolve_collision_( pair.a, pair.b );
+}
+
+void AsteroidField::resolve_collision_( std::uint32_t aA, std::uint32_t aB ) noexcept
+{
+	float* const posX = mAsteroids.posX.data();
+	float* const posY = mAsteroids.posY.data();
+	float* const velX = mAsteroids.velX.data();
+	float* const velY = mAsteroids.velY.data();
+	float const* const radius = mAsteroids.radius.data();
+
+	float const dx = posX[aB] - posX[aA];
+	float const dy = posY[aB] - posY[aA];
+	float const reach = radius[aA] + radius[aB];
+
+	float const distSquared = dx*dx + dy*dy;
+	if( distSquared >= reach*reach || distSquared <= 0.f )
+		return;
+
+	float const dist = std::sqrt( distSquared );
+	float const nx = dx / dist, ny = dy / dist;
+
+	// Masses are proportional to the area.
+	float const massA = radius[aA]*radius[aA];
+	float const massB = radius[aB]*radius[aB];
+	float const invMass = 1.f / (massA + massB);
+
+	// Separate the two, the lighter one moves further.
+	float const overlap = reach - dist;
+	posX[aA] -= nx * overlap * massB * invMass;
+	posY[aA] -= ny * overlap * massB * invMass;
+	posX[aB] += nx * overlap * massA * invMass;
+	posY[aB] += ny * overlap * massA * invMass;
+
+	// Elastic collision, if the two are approaching
+	float const vn = (velX[aB] - velX[aA]) * nx + (velY[aB] - velY[aA]) * ny;
+	if( vn >= 0.f )
+		return;
+
+	float const impulse = 2.f * vn * invMass;
+	velX[aA] += impulse * massB * nx;
+	velY[aA] += impulse * massB * ny;
+	velX[aB] -= impulse * massA * nx;
+	velY[aB] -= impulse * massA * ny;
+
+	// Don't break the speed limits. The space police will get you! Scale the
+	// whole velocity, such that the bounce keeps its direction.
+	limit_speed_( velX[aA], velY[aA], mMaximumSpeed );
+	limit_speed_( velX[aB], velY[aB], mMaximumSpeed );
+}
+
+void AsteroidField::rebuild_grid_()
+{
+	mGrid.build(
+		mAsteroids.size(),
+		mAsteroids.posX.data(), mAsteroids.posY.data(),
+		mBoundsMin, mBoundsMax
+	);
+}
+
+
+void AsteroidField::Asteroids_::resize( std::size_t aCount )
+{
+	posX.resize( aCount );
+	posY.resize( aCount );
+	prevX.resize( aCount );
+	prevY.resize( aCount );
+	velX.resize( aCount );
+	velY.resize( aCount );
+	angle.resize( aCount );
+	radpersec.resize( aCount );
+	prototype.resize( aCount );
+	scale.resize( aCount );
+	tint.resize( aCount );
+	radius.resize( aCount );
+}
+
+void AsteroidField::Asteroids_::move( std::size_t aTo, std::size_t aFrom )
+{
+	assert( aTo < size() && aFrom < size() );
+
+	posX[aTo] = posX[aFrom];
+	posY[aTo] = posY[aFrom];
+	prevX[aTo] = prevX[aFrom];
+	prevY[aTo] = prevY[aFrom];
+	velX[aTo] = velX[aFrom];
+	velY[aTo] = velY[aFrom];
+	angle[aTo] = angle[aFrom];
+	radpersec[aTo] = radpersec[aFrom];
+	prototype[aTo] = prototype[aFrom];
+	scale[aTo] = scale[aFrom];
+	tint[aTo] = tint[aFrom];
+	radius[aTo] = radius[aFrom];
+}
+
+namespace
+{
+	void limit_speed_( float& aVelX, float& aVelY, float aMaxSpeed ) noexcept
+	{
+		float const speedSquared = aVelX*aVelX + aVelY*aVelY;
+		if( speedSquared <= aMaxSpeed*aMaxSpeed )
+			return;
+
+		float const scale = aMaxSpeed / std::sqrt( speedSquared );
+		aVelX *= scale;
+		aVelY *= scale;
+	}
+
+	float cross_( Vec2f aA, Vec2f aB ) noexcept
+	{
+		return aA.x*aB.y - aA.y*aB.x;
+	}
+
+	bool inside_triangle_( Vec2f aP, Vec2f aA, Vec2f aB, Vec2f aC ) noexcept
+	{
+		// Either winding; points on the edges count as inside.
+		float const d0 = cross_( aB - aA, aP - aA );
+		float const d1 = cross_( aC - aB, aP - aB );
+		float const d2 = cross_( aA - aC, aP - aC );
+
+		bool const anyNeg = d0 < 0.f || d1 < 0.f || d2 < 0.f;
+		bool const anyPos = d0 > 0.f || d1 > 0.f || d2 > 0.f;
+		return !(anyNeg && anyPos);
+	}
+
+	bool segments_cross_( Vec2f aP0, Vec2f aP1, Vec2f aQ0, Vec2f aQ1 ) noexcept
+	{
+		// The endpoints of each segment are on different sides of (or on)
+		// the other one's line. Collinear overlaps are not detected; the
+		// point-in-triangle tests catch those.
+		Vec2f const p = aP1 - aP0;
+		Vec2f const q = aQ1 - aQ0;
+
+		float const a0 = cross_( p, aQ0 - aP0 ), a1 = cross_( p, aQ1 - aP0 );
+		float const b0 = cross_( q, aP0 - aQ0 ), b1 = cross_( q, aP1 - aQ0 );
+
+		return a0*a1 <= 0.f && b0*b1 <= 0.f && (a0 != a1) && (b0 != b1);
+	}
+
+	bool inside_polygon_( Vec2f aPoint, std::size_t aCount, Vec2f const* aPolygon ) noexcept
+	{
+		// Crossing number. aPolygon is closed (the last vertex repeats the
+		// first one).
+		bool inside = false;
+		for( std::size_t i = 0; i+1 < aCount; ++i )
+		{
+			Vec2f const a = aPolygon[i], b = aPolygon[i+1];
+			if( (a.y > aPoint.y) != (b.y > aPoint.y) )
+			{
+				float const x = a.x + (aPoint.y - a.y) / (b.y - a.y) * (b.x - a.x);
+				if( aPoint.x < x )
+					inside = !inside;
+			}
+		}
+
+		return inside;
+	}
+}
+
+namespace detail
+{
+	bool outline_hits_fan( std::size_t aCount, Vec2f const* aOutline, std::size_t aFanCount, Vec2f const* aFan ) noexcept
+	{
+		if( aFanCount < 3 )
+			return false;
+
+		Vec2f const center = aFan[0];
+		Vec2f const* const rim = aFan + 1;
+		std::size_t const rimCount = aFanCount - 1;
+
+		// Segment vs. triangle: a segment touches a triangle if one of its
+		// endpoints is inside, or if it crosses one of the edges. The fan's
+		// spokes are shared by two triangles, so a segment that crosses a
+		// spoke either has an endpoint in one of the triangles, or crosses
+		// the rim as well. Only the rim edges need to be tested.
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			for( std::size_t j = 0; j < rimCount; ++j )
+			{
+				if( inside_triangle_( aOutline[i], center, rim[j], rim[(j+1) % rimCount] ) )
+					return true;
+			}
+		}
+
+		for( std::size_t i = 0; i+1 < aCount; ++i )
+		{
+			for( std::size_t j = 0; j < rimCount; ++j )
+			{
+				if( segments_cross_( aOutline[i], aOutline[i+1], rim[j], rim[(j+1) % rimCount] ) )
+					return true;
+			}
+		}
+
+		return false;
+	}
+}
@@ -3,14 +3,18 @@
 
 #include <vector>
 
+#include <cstdint>
 #include <cstdlib>
 
 #include "../draw2d/forward.hpp"
+#include "../draw2d/color.hpp"
 
 #include "../vmlib/vec2.hpp"
 #include "../vmlib/mat22.hpp"
 
 #include "defaults.hpp"
+#include "spatial_grid.hpp"
+#include "sweep_prune.hpp"
 
 /** Asteroid field
  *
@@ -23,20 +27,32 @@
  * a asteroid exits the screen, the player turns around immediately, the same
  * asteroid still exists).
  *
- * With the current implementation, the asteroid field is a purely visual
- * effect.
+ * Asteroids bounce off each other. Collisions are found with a sweep and
+ * prune along the x axis (see SweepAndPrune), and resolved as elastic collisions between the
+ * asteroids' bounding circles (with masses proportional to their areas).
+ *
+ * The field keeps a uniform grid over the asteroids (see SpatialGrid), which
+ * is rebuilt by update() and resize(). query_radius() and query_aabb() use it
+ * to find asteroids near a point or region without visiting all of them.
+ *
+ * Asteroids are instances of a small library of shapes (prototypes), which
+ * are generated once, up front. Each asteroid only stores the index of its
+ * prototype, a scale and a color tint. Shape memory thus does not grow with
+ * the number of asteroids, and respawning an asteroid does not generate a new
+ * shape.
  */
 class AsteroidField
 {
 	public:
 		AsteroidField(
-			RNG&,
+			RNG,
 			std::uint32_t aImageWidth, std::uint32_t aImageHeight,
 			float aDensity = 1e-5f,
 			float aInitialSpeedStddev = 100.f,
 			float aMaximumSpeed = 500.f,
 			float aInitialRotStddev = 1.5f,
-			float aPadding = 300.f
+			float aPadding = 300.f,
+			std::size_t aPrototypeCount = 32
 		);
 
 		~AsteroidField();
@@ -48,32 +64,142 @@ class AsteroidField
 	public:
 		void update( float aElapsedTimeSec, Vec2f const& aMovement );
 
-		void draw( Surface& ) const;
+		// See ParticleField::draw()
+		void draw( Surface&, float aAlpha = 1.f ) const;
 
 		void resize( std::uint32_t aWidth, std::uint32_t aHeight );
 
+	public:
+		/* Append the indices of the asteroids whose bounding circles overlap
+		 * the circle or rectangle to the output. Indices remain valid until
+		 * the next call to update() or resize().
+		 */
+		void query_radius( Vec2f aCenter, float aRadius, std::vector<std::uint32_t>& ) const;
+		void query_aabb( Vec2f aMin, Vec2f aMax, std::vector<std::uint32_t>& ) const;
+
+		/* Append the indices of the asteroids that touch the line strip
+		 * to the output. The strip is transformed like in LineStrip::draw().
+		 *
+		 * Candidates are found with query_radius() and the strip's bounding
+		 * circle. They are then tested exactly against the asteroid's shape:
+		 * each segment of the strip is tested against the fan's triangles.
+		 * If the strip is closed (the last vertex equals the first one), an
+		 * asteroid that lies completely inside of it also counts.
+		 */
+		void query_line_strip( LineStrip const&, Mat22f const&, Vec2f const&, std::vector<std::uint32_t>& ) const;
+
+		std::size_t asteroid_count() const noexcept { return mAsteroids.size(); }
+
+		Vec2f get_position( std::size_t ) const noexcept;
+		float get_radius( std::size_t ) const noexcept; // Scaled bounding radius
+
+		/* Complete state of a single asteroid
+		 *
+		 * This is mainly intended for tests. set_state() places the asteroid
+		 * like a respawn does (i.e., without interpolation from its previous
+		 * position) and rebuilds the grid. The bounding radius follows from
+		 * the prototype and the scale.
+		 */
+		struct State
+		{
+			Vec2f position, velocity;
+			float angle, radpersec;
+
+			std::uint32_t prototype;
+			float scale;
+			ColorF tint;
+		};
+
+		State get_state( std::size_t ) const noexcept;
+		void set_state( std::size_t, State const& );
+
+		// Shapes referenced by State::prototype (in local space, unscaled)
+		std::size_t prototype_count() const noexcept;
+		TriangleFan const& get_prototype( std::uint32_t ) const noexcept;
+
 	private:
-		struct Asteroid_
+		/* Asteroid state, as a structure of arrays
+		 *
+		 * update() streams through the position, velocity and angle arrays
+		 * only. The rotation is stored as an angle, and the matrix is only
+		 * built when an asteroid is drawn.
+		 */
+		struct Asteroids_
 		{
-			Vec2f pos;
-			Vec2f vel;
-			
-			Mat22f rot;
-			float radpersec;
+			std::vector<float> posX, posY;
+			std::vector<float> velX, velY;
+
+			std::vector<float> prevX, prevY; // Position before update()
+
+			std::vector<float> angle;
+			std::vector<float> radpersec;
+
+			std::vector<std::uint32_t> prototype;
+			std::vector<float> scale;
+			std::vector<ColorF> tint;
+
+			std::vector<float> radius; // Scaled bounding radius
+
+			std::size_t size() const noexcept { return posX.size(); }
+
+			void resize( std::size_t );
+			void move( std::size_t aTo, std::size_t aFrom ); // Copy all fields
+		};
+
+		/* Random parameters for a (re-)spawned asteroid
+		 *
+		 * Respawns take these from a pool (mLaunchPool), which update()
+		 * refills by a fixed amount per call. Sampling cost is thus spread
+		 * over frames, even if many asteroids leave the area at once.
+		 */
+		struct Launch_
+		{
+			float velX, velY;
+			float angle, radpersec;
+
+			std::uint32_t prototype;
+			float scale;
+			ColorF tint;
 		};
 
+	private:
+		void launch_( std::size_t ); // Random velocity, rotation and shape
+		void sample_launches_( std::size_t ); // Append to mLaunchPool
+
+		void collide_();
+		void resolve_collision_( std::uint32_t, std::uint32_t ) noexcept;
+		void rebuild_grid_();
+
 	private:
 		Vec2f mBoundsMin, mBoundsMax;
 		Vec2f mExactExtent, mActualExtent;
 		
-		std::vector<Asteroid_> mAsteroids;
-		std::vector<TriangleFan> mShapes;
+		Asteroids_ mAsteroids;
+		std::vector<TriangleFan> mPrototypes;
+		float mMaxRadius; // Largest scaled bounding radius of any asteroid
+
+		SpatialGrid mGrid;
+
+		SweepAndPrune mSweep;
+		std::vector<SweepAndPrune::Pair> mCollisionPairs; // Scratch for collide_()
+		std::vector<std::uint32_t> mRespawns; // Scratch for update()
+		std::vector<float> mRandom; // Scratch for random numbers
+		std::vector<Launch_> mLaunchPool;
+
+		float mLastElapsed; // Time step of the last update()
 
 		float mInitialSpeed, mMaximumSpeed;
 		float mInitialRot;
 		float mPadding, mDensity;
 
-		RNG& mRNG;
+		RNG mRNG;
 };
 
+namespace detail
+{
+	// Narrow phase of AsteroidField::query_line_strip(): does the polyline
+	// touch any of the fan's triangles? Both are in the same space.
+	bool outline_hits_fan( std::size_t aCount, Vec2f const* aOutline, std::size_t aFanCount, Vec2f const* aFan ) noexcept;
+}
+
 #endif // ASTEROID_FIELD_HPP_7D5A0B40_4466_4CAC_B7CC_85E8DC927E08
@@ -2,16 +2,21 @@
 
 #include "../draw2d/image.hpp"
 
-Background::Background( RNG& aRNG, std::uint32_t aImageWidth, std::uint32_t aImageHeight )
+Background::Background( RNG const& aRNG, std::uint32_t aImageWidth, std::uint32_t aImageHeight )
+	: Background( aRNG, aImageWidth, aImageHeight, *load_image_cached( kEarthPath ) )
+{}
+
+Background::Background( RNG const& aRNG, std::uint32_t aImageWidth, std::uint32_t aImageHeight, ImageRGBA const& aEarthImage )
 	: mFarField{
-		{ aRNG, aImageWidth, aImageHeight, kFarColors[0], kFarDensities[0], kFarSpeedMults[0] },
-		{ aRNG, aImageWidth, aImageHeight, kFarColors[1], kFarDensities[1], kFarSpeedMults[1] },
-		{ aRNG, aImageWidth, aImageHeight, kFarColors[2], kFarDensities[2], kFarSpeedMults[2] }
+		{ aRNG.fork( 0 ), aImageWidth, aImageHeight, kFarColors[0], kFarDensities[0], kFarSpeedMults[0] },
+		{ aRNG.fork( 1 ), aImageWidth, aImageHeight, kFarColors[1], kFarDensities[1], kFarSpeedMults[1] },
+		{ aRNG.fork( 2 ), aImageWidth, aImageHeight, kFarColors[2], kFarDensities[2], kFarSpeedMults[2] }
 	}
-	, mNearField{ aRNG, aImageWidth, aImageHeight, kNearColor, kNearDensity, kNearSpeedMult }
+	, mNearField{ aRNG.fork( 3 ), aImageWidth, aImageHeight, kNearColor, kNearDensity, kNearSpeedMult }
+	, mEarthSprite( make_sprite( aEarthImage ) )
 {
-	mEarthSprite = load_image( kEarthPath );
 	mCurrentPosition = Vec2f{ 0.f, 0.f };
+	mPreviousPosition = mCurrentPosition;
 }
 
 Background::~Background() = default;
@@ -25,20 +30,22 @@ void Background::update( Vec2f aPosition, Vec2f aMovementDelta )
 	mNearField.update( aMovementDelta );
 
 	// Store current position
+	mPreviousPosition = mCurrentPosition;
 	mCurrentPosition = aPosition;
 }
 
-void Background::draw( Surface& aSurface )
+void Background::draw( Surface& aSurface, float aAlpha )
 {
 	// Draw far field first
 	for( auto const& pf : mFarField )
-		pf.draw( aSurface );
+		pf.draw( aSurface, aAlpha );
 
 	// Draw earth sprite
-	blit_masked( aSurface, *mEarthSprite, kEarthCoord - mCurrentPosition );
+	Vec2f const position = mPreviousPosition + aAlpha * (mCurrentPosition - mPreviousPosition);
+	blit_masked( aSurface, mEarthSprite, kEarthCoord - position );
 
 	// Draw near field = dirt layer
-	mNearField.draw( aSurface );
+	mNearField.draw( aSurface, aAlpha );
 }
 
 void Background::resize( std::uint32_t aImageWidth, std::uint32_t aImageHeight )
@@ -5,6 +5,7 @@
 
 #include "../draw2d/forward.hpp"
 #include "../draw2d/color.hpp"
+#include "../draw2d/sprite.hpp"
 
 #include "../vmlib/vec2.hpp"
 
@@ -14,13 +15,19 @@
 class Background final
 {
 	public:
-		Background( RNG&, std::uint32_t aImageWidth, std::uint32_t aImageHeight );
+		// The particle fields use streams forked from the RNG.
+		Background( RNG const&, std::uint32_t aImageWidth, std::uint32_t aImageHeight );
+
+		// Use an already loaded Earth image (e.g., from load_image_async())
+		// instead of loading kEarthPath in the constructor.
+		Background( RNG const&, std::uint32_t aImageWidth, std::uint32_t aImageHeight, ImageRGBA const& aEarthImage );
 		~Background();
 
 	public:
 		void update( Vec2f aPosition, Vec2f aMovementDelta );
 
-		void draw( Surface& );
+		// See ParticleField::draw()
+		void draw( Surface&, float aAlpha = 1.f );
 
 		void resize( std::uint32_t aImageWidth, std::uint32_t aImageHeight );
 
@@ -28,9 +35,10 @@ class Background final
 		ParticleField mFarField[3];
 		ParticleField mNearField;
 		
-		std::unique_ptr<ImageRGBA> mEarthSprite;
+		SpriteRGBx mEarthSprite;
 
 		Vec2f mCurrentPosition;
+		Vec2f mPreviousPosition;
  
 	public: // Configuration values. Mostly empirically determined
 		static constexpr std::size_t kFarLayers = 3;
@@ -4,12 +4,16 @@
 #include <chrono>
 #include <random>
 
+#include "philox.hpp"
+
 /* Select default random number generator
  *
- * We don't need very high quality random numbers in this case, so we can
- * opt for a fast (but fairly low quality) LCG-based generator.
+ * The counter-based Philox generator lets each subsystem own an independent
+ * stream (see Philox4x32::fork()). Subsystems therefore do not share state:
+ * they could be updated in parallel, and their random sequences do not change
+ * when another consumer of random numbers is added or reordered.
  */
-using RNG = std::minstd_rand;
+using RNG = Philox4x32;
 
 /* Select default clock
  *
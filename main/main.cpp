@@ -2,15 +2,19 @@
 #include <GLFW/glfw3.h>
 
 #include <random>
+#include <vector>
 #include <typeinfo>
 #include <stdexcept>
 
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstdint>
 
 #include "../draw2d/surface.hpp"
 #include "../draw2d/draw.hpp"
 #include "../draw2d/shape.hpp"
+#include "../draw2d/image.hpp"
 
 #include "../support/error.hpp"
 #include "../support/context.hpp"
@@ -29,6 +33,22 @@ namespace
 {
 	constexpr char const* kWindowTitle = "COMP3811-Coursework 1";
 
+	// The simulation advances in fixed steps, independent of the frame rate.
+	// If a frame falls further behind than kMaxSimStepsPerFrame steps, the
+	// remaining time is dropped (the simulation slows down, rather than
+	// spending ever more time on catching up).
+	//
+	// A step at the display's usual 60 Hz means a single asteroid update per
+	// frame; at high asteroid densities, that update alone takes a large part
+	// of the frame budget.
+	constexpr float kSimStep = 1.f / 60.f;
+	constexpr int kMaxSimStepsPerFrame = 4;
+
+	// Random number streams of the subsystems (see Philox4x32::fork()).
+	// Existing values must not change; add new ones at the end.
+	constexpr std::uint64_t kRngBackground = 1;
+	constexpr std::uint64_t kRngAsteroids = 2;
+
 	void glfw_callback_error_( int, char const* );
 
 	void glfw_callback_key_( GLFWwindow*, int, int, int, int );
@@ -51,6 +71,10 @@ int main( int aArgc, char* aArgv[] ) try
 	// Parse command line arguments
 	RuntimeConfig const config = parse_command_line( aArgc, aArgv );
 
+	// Start loading assets in the background. The images are decoded while
+	// we set up the window and OpenGL context below.
+	auto earthImage = load_image_async( Background::kEarthPath );
+
 	// Initialize GLFW
 	if( GLFW_TRUE != glfwInit() )
 	{
@@ -152,16 +176,18 @@ int main( int aArgc, char* aArgv[] ) try
 	glViewport( 0, 0, iwidth, iheight );
 
 	// Resources
-	RNG rng( std::random_device{}() );
+	RNG const rng( config.fixedSeed ? config.seed : std::random_device{}() );
 
-	Background background( rng, fbwidth, fbheight );
-	AsteroidField asteroids( rng, fbwidth, fbheight );
+	Background background( rng.fork( kRngBackground ), fbwidth, fbheight, *earthImage.get() );
+	AsteroidField asteroids( rng.fork( kRngAsteroids ), fbwidth, fbheight );
 
 	auto const spaceship = make_spaceship_shape();
+	std::vector<std::uint32_t> shipHits;
 
 
 	// Main loop
 	auto lastUpdateTime = Clock::now();
+	float simAccumulator = 0.f;
 
 	while( !glfwWindowShouldClose( window ) )
 	{
@@ -214,20 +240,45 @@ int main( int aArgc, char* aArgv[] ) try
 		auto const dt = std::chrono::duration_cast<Secondsf>(now - lastUpdateTime).count();
 		lastUpdateTime = now;
 
-		state_update( state, dt );
+		simAccumulator += dt;
+
+		int steps = 0;
+		for( ; simAccumulator >= kSimStep && steps < kMaxSimStepsPerFrame; ++steps )
+		{
+			state_update( state, kSimStep );
+
+			background.update( state.player.position, state.thisFrame.movement );
+			asteroids.update( kSimStep, state.thisFrame.movement );
+
+			simAccumulator -= kSimStep;
+		}
 
-		background.update( state.player.position, state.thisFrame.movement );
-		asteroids.update( state.thisFrame.dt, state.thisFrame.movement );
+		if( simAccumulator >= kSimStep )
+			simAccumulator = std::fmod( simAccumulator, kSimStep );
+
+		// Draw the world between the last two simulation steps
+		float const alpha = simAccumulator / kSimStep;
+
+		auto const rot = make_rotation_2d( state.player.angle );
+		auto const offs = Vec2f{ fbwidth*0.5f, fbheight*0.5f };
+
+		// Check for collisions between the ship and the asteroids. For now,
+		// this only changes the color of the ship.
+		shipHits.clear();
+		asteroids.query_line_strip( spaceship, rot, offs, shipHits );
+
+		ColorF const shipColor = shipHits.empty()
+			? ColorF{ 0.2f, 0.4f, 0.7f }
+			: ColorF{ 0.9f, 0.2f, 0.2f }
+		;
 	
 		// Draw scene
 		surface.clear();
 
-		background.draw( surface );
-		asteroids.draw( surface );
+		background.draw( surface, alpha );
+		asteroids.draw( surface, alpha );
 
-		auto const rot = make_rotation_2d( state.player.angle );
-		auto const offs = Vec2f{ fbwidth*0.5f, fbheight*0.5f };
-		spaceship.draw( surface, { 0.2f, 0.4f, 0.7f }, rot, offs );
+		spaceship.draw( surface, shipColor, rot, offs );
 
 		context.draw( surface );
 
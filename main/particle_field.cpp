@@ -2,15 +2,19 @@
 
 #include "../draw2d/surface.hpp"
 
+#include <algorithm>
+
 #include <cassert> 
 
-ParticleField::ParticleField( RNG& aRNG, std::uint32_t aImageWidth, std::uint32_t aImageHeight, ColorF const& aParticleColor, float aParticleDensity, float aParticleSpeedMult, float aPadding )
+ParticleField::ParticleField( RNG aRNG, std::uint32_t aImageWidth, std::uint32_t aImageHeight, ColorF const& aParticleColor, float aParticleDensity, float aParticleSpeedMult, float aPadding )
 	: mColor( linear_to_srgb( aParticleColor ) )
 	, mParticleSpeedMult( aParticleSpeedMult )
 	, mParticleDensity( aParticleDensity )
 	, mPadding( aPadding )
 	, mRNG( aRNG )
 {
+	mLastDelta = Vec2f{ 0.f, 0.f };
+
 	// Store extents
 	mVisibleExtent.x = float(aImageWidth);
 	mVisibleExtent.y = float(aImageHeight);
@@ -28,68 +32,92 @@ ParticleField::ParticleField( RNG& aRNG, std::uint32_t aImageWidth, std::uint32_
 	mParticles.resize( particleCount );
 
 	// Initialize particles
-	std::uniform_real_distribution<float> xdist( mBoxMin.x, mBoxMax.x );
-	std::uniform_real_distribution<float> ydist( mBoxMin.y, mBoxMax.y );
+	mRandom.resize( 2*particleCount );
+	mRNG.fill_uniform( mRandom.size(), mRandom.data() );
 
-	for( auto& p : mParticles )
+	for( std::size_t i = 0; i < particleCount; ++i )
 	{
-		p.x = xdist(mRNG);
-		p.y = ydist(mRNG);
+		mParticles[i].x = mBoxMin.x + mRandom[2*i+0] * extent.x;
+		mParticles[i].y = mBoxMin.y + mRandom[2*i+1] * extent.y;
 	}
 }
 
 
-void ParticleField::update( Vec2f aDelta ) noexcept
+void ParticleField::update( Vec2f aDelta )
 {
 	// Note: the delta here is reversed -- the particles move in the 
 	// opposite direction as the "player".
 	auto const delta = -mParticleSpeedMult * aDelta;
-
-	std::uniform_real_distribution<float> xdist( mBoxMin.x, mBoxMax.x );
-	std::uniform_real_distribution<float> ydist( mBoxMin.y, mBoxMax.y );
+	mLastDelta = delta;
 
 	float const padX = std::max( std::abs(aDelta.x), mPadding );
 	float const padY = std::max( std::abs(aDelta.y), mPadding );
 
-	std::uniform_real_distribution<float> xpad( 0.f, padX );
-	std::uniform_real_distribution<float> ypad( 0.f, padY );
+	// Move all particles. Particles that leave the box are collected in
+	// mRespawns, and get their new positions afterwards, from one bulk batch
+	// of random numbers. (Only few particles leave the box in each update,
+	// so the branch is well predicted.)
+	mRespawns.clear();
+
+	auto const numParticles = mParticles.size();
+	Vec2f* const particles = mParticles.data();
+
+	for( std::size_t i = 0; i < numParticles; ++i )
+	{
+		Vec2f const p = particles[i] + delta;
+		particles[i] = p;
+
+		if( p.x < mBoxMin.x || p.x > mBoxMax.x || p.y < mBoxMin.y || p.y > mBoxMax.y )
+			mRespawns.emplace_back( std::uint32_t(i) );
+	}
+
+	// Two random numbers in [0,1] per respawned particle
+	auto const respawnCount = mRespawns.size();
 
+	mRandom.resize( 2*respawnCount );
+	mRNG.fill_uniform( mRandom.size(), mRandom.data() );
 
-	for( auto& particle : mParticles )
+	Vec2f const extent = mBoxMax - mBoxMin;
+
+	for( std::size_t j = 0; j < respawnCount; ++j )
 	{
-		Vec2f p = particle + delta;
+		auto& p = mParticles[mRespawns[j]];
+		float const u = mRandom[2*j+0];
+		float const v = mRandom[2*j+1];
 
 		if( p.x < mBoxMin.x )
 		{
-			p.x = mBoxMax.x - xpad(mRNG);
-			p.y = ydist(mRNG);
+			p.x = mBoxMax.x - u * padX;
+			p.y = mBoxMin.y + v * extent.y;
 		}
 		else if( p.x > mBoxMax.x )
 		{
-			p.x = mBoxMin.x + xpad(mRNG);
-			p.y = ydist(mRNG);
+			p.x = mBoxMin.x + u * padX;
+			p.y = mBoxMin.y + v * extent.y;
 		}
-
-		if( p.y < mBoxMin.y )
+		else if( p.y < mBoxMin.y )
 		{
-			p.x = xdist(mRNG);
-			p.y = mBoxMax.y - ypad(mRNG);
+			p.x = mBoxMin.x + u * extent.x;
+			p.y = mBoxMax.y - v * padY;
 		}
-		else if( p.y > mBoxMax.y )
+		else
 		{
-			p.x = xdist(mRNG);
-			p.y = mBoxMin.y + ypad(mRNG);
+			assert( p.y > mBoxMax.y );
+			p.x = mBoxMin.x + u * extent.x;
+			p.y = mBoxMin.y + v * padY;
 		}
-
-		particle = p;
 	}
 }
 
-void ParticleField::draw( Surface& aSurface ) const
+void ParticleField::draw( Surface& aSurface, float aAlpha ) const
 {
+	// Particles that wrapped around in the last update are off-screen, so
+	// shifting them all back by the same amount is fine.
+	auto const offset = Vec2f{ .5f, .5f } - (1.f - aAlpha) * mLastDelta;
+
 	for( auto const& particle : mParticles )
 	{
-		auto const p = particle + Vec2f{ .5f, .5f };
+		auto const p = particle + offset;
 
 		if( p.x < 0.f || p.y < 0.f )
 			continue;
@@ -118,17 +146,14 @@ void ParticleField::resize( std::uint32_t aImageWidth, std::uint32_t aImageHeigh
 	float const particleCountf = totalArea * mParticleDensity;
 	std::size_t const particleCount = std::size_t(particleCountf+0.5f);
 
-	// Remove particles now outside
-	std::size_t activeParticles = 0;
-	for( auto it = mParticles.begin(); it != mParticles.end(); )
-	{
-		auto const& part = *it;
+	// Remove particles now outside (erase-remove: a single pass, instead of
+	// one erase per removed particle)
+	auto const outside = [this] (Vec2f const& aPart) {
+		return aPart.x > mBoxMax.x || aPart.y > mBoxMax.y;
+	};
 
-		if( part.x > mBoxMax.x || part.y > mBoxMax.y )
-			it = mParticles.erase( it );
-		else
-			++it, ++activeParticles;
-	}
+	mParticles.erase( std::remove_if( mParticles.begin(), mParticles.end(), outside ), mParticles.end() );
+	std::size_t const activeParticles = mParticles.size();
 
 	mParticles.resize( particleCount ); // This may kill a few visible particles..
 
@@ -3,6 +3,7 @@
 
 #include <vector>
 
+#include <cstdint>
 #include <cstdlib>
 
 #include "../draw2d/forward.hpp"
@@ -16,7 +17,7 @@ class ParticleField final
 {
 	public:
 		ParticleField( 
-			RNG& aRNG,
+			RNG aRNG,
 			std::uint32_t aImageWidth, std::uint32_t aImageHeight,
 			ColorF const& aParticleColor,
 			float aParticleDensity,
@@ -25,14 +26,18 @@ class ParticleField final
 		);
 
 	public:
-		void update( Vec2f aMovementDelta ) noexcept;
+		void update( Vec2f aMovementDelta );
 
-		void draw( Surface& ) const;
+		/* Draw the particles. aAlpha interpolates between the positions
+		 * before (0) and after (1) the last update().
+		 */
+		void draw( Surface&, float aAlpha = 1.f ) const;
 
 		void resize( std::uint32_t aImageWidth, std::uint32_t aImageHeight );
 	
 	private:
 		std::vector<Vec2f> mParticles;
+		Vec2f mLastDelta; // Movement applied by the last update()
 
 		ColorU8_sRGB mColor;
 
@@ -43,7 +48,10 @@ class ParticleField final
 		Vec2f mVisibleExtent;
 		Vec2f mBoxMin, mBoxMax;
 
-		RNG& mRNG;
+		RNG mRNG;
+
+		std::vector<std::uint32_t> mRespawns; // Scratch for update()
+		std::vector<float> mRandom; // Scratch for random numbers
 };
 
 #endif // PARTICLE_FIELD_HPP_5A795E6D_C839_4944_9020_1AF0FEFE3EFC
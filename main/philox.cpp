@@ -0,0 +1,257 @@
+#include "philox.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include <cassert>
+
+#if defined(__AVX2__)
+#	define MAIN_PHILOX_AVX2 1
+#	include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define MAIN_PHILOX_SSE2 1
+#	include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr float kTwoPi = 2.f * 3.1415926535897932385f;
+
+	// 24 random bits map exactly to floats in [0, 1)
+	constexpr float kUnitScale = 1.f / 16777216.f; // 2^-24
+
+	// Raw values are generated in chunks on the stack, then converted. The
+	// conversion goes through int32 (exact for 24 bits), which vectorizes.
+	constexpr std::size_t kChunkSize = 256;
+
+	void generate_blocks_( std::uint64_t aSeed, std::uint64_t aStream, std::uint64_t aFirstBlock, std::size_t aBlockCount, std::uint32_t* aOut ) noexcept;
+}
+
+void Philox4x32::fill_uniform( std::size_t aCount, float* aOut, float aMin, float aMax ) noexcept
+{
+	assert( aOut || 0 == aCount );
+
+	float const scale = (aMax - aMin) * kUnitScale;
+
+	std::uint32_t bits[kChunkSize];
+	while( aCount )
+	{
+		auto const count = std::min( aCount, kChunkSize );
+		fill_bits_( count, bits );
+
+		for( std::size_t i = 0; i < count; ++i )
+			aOut[i] = aMin + float(std::int32_t(bits[i] >> 8)) * scale;
+
+		aOut += count;
+		aCount -= count;
+	}
+}
+
+void Philox4x32::fill_normal( std::size_t aCount, float* aOut, float aMean, float aStddev ) noexcept
+{
+	assert( aOut || 0 == aCount );
+
+	std::uint32_t bits[kChunkSize];
+	while( aCount )
+	{
+		auto const pairs = std::min( (aCount+1) / 2, kChunkSize / 2 );
+		fill_bits_( 2*pairs, bits );
+
+		for( std::size_t i = 0; i < pairs; ++i )
+		{
+			// u1 in (0, 1] to keep the logarithm finite
+			float const u1 = float(std::int32_t(bits[2*i+0] >> 8) + 1) * kUnitScale;
+			float const u2 = float(std::int32_t(bits[2*i+1] >> 8)) * kUnitScale;
+
+			float const r = aStddev * std::sqrt( -2.f * std::log( u1 ) );
+			float const theta = kTwoPi * u2;
+
+			aOut[2*i+0] = aMean + r * std::cos( theta );
+			if( 2*i+1 < aCount )
+				aOut[2*i+1] = aMean + r * std::sin( theta );
+		}
+
+		auto const count = std::min( aCount, 2*pairs );
+		aOut += count;
+		aCount -= count;
+	}
+}
+
+void Philox4x32::fill_bits_( std::size_t aCount, result_type* aOut ) noexcept
+{
+	// Drain the values left over from operator()
+	for( ; aCount && mIndex < 4; --aCount )
+		*aOut++ = mBuffer[mIndex++];
+
+	// Whole blocks go straight to the output
+	auto const blocks = aCount / 4;
+	generate_blocks_( mSeed, mStream, mBlock, blocks, aOut );
+	mBlock += blocks;
+	aOut += 4*blocks;
+	aCount -= 4*blocks;
+
+	// Keep the rest of a partial block for later
+	if( aCount )
+	{
+		generate_block( mSeed, mStream, mBlock++, mBuffer );
+		mIndex = 0;
+
+		for( ; aCount; --aCount )
+			*aOut++ = mBuffer[mIndex++];
+	}
+}
+
+
+namespace
+{
+	void generate_blocks_( std::uint64_t aSeed, std::uint64_t aStream, std::uint64_t aFirstBlock, std::size_t aBlockCount, std::uint32_t* aOut ) noexcept
+	{
+		std::size_t i = 0;
+
+		// The SIMD versions compute one block per lane: lane j holds the
+		// counter of block i+j, with word k of all lanes in register k.
+		// Blocks are transposed back into order when stored.
+#		if defined(MAIN_PHILOX_AVX2)
+		{
+			__m256i const mul0 = _mm256_set1_epi32( int(Philox4x32::kMul0) );
+			__m256i const mul1 = _mm256_set1_epi32( int(Philox4x32::kMul1) );
+			__m256i const streamLo = _mm256_set1_epi32( int(std::uint32_t(aStream)) );
+			__m256i const streamHi = _mm256_set1_epi32( int(std::uint32_t(aStream >> 32)) );
+
+			// 32x32 -> 64 bit products of all lanes; _mm256_mul_epu32 only
+			// handles the even lanes, so the odd lanes are shifted down.
+			auto const mulhilo = [] (__m256i aA, __m256i aMul, __m256i& aHi, __m256i& aLo) {
+				__m256i const even = _mm256_mul_epu32( aA, aMul );
+				__m256i const odd = _mm256_mul_epu32( _mm256_srli_epi64( aA, 32 ), aMul );
+				aLo = _mm256_unpacklo_epi32(
+					_mm256_shuffle_epi32( even, _MM_SHUFFLE(3,1,2,0) ),
+					_mm256_shuffle_epi32( odd, _MM_SHUFFLE(3,1,2,0) )
+				);
+				aHi = _mm256_unpacklo_epi32(
+					_mm256_shuffle_epi32( even, _MM_SHUFFLE(2,0,3,1) ),
+					_mm256_shuffle_epi32( odd, _MM_SHUFFLE(2,0,3,1) )
+				);
+			};
+
+			for( ; i+8 <= aBlockCount; i += 8 )
+			{
+				alignas(32) std::uint32_t lo[8], hi[8];
+				for( int lane = 0; lane < 8; ++lane )
+				{
+					std::uint64_t const block = aFirstBlock + i + lane;
+					lo[lane] = std::uint32_t(block);
+					hi[lane] = std::uint32_t(block >> 32);
+				}
+
+				__m256i c0 = _mm256_load_si256( reinterpret_cast<__m256i const*>(lo) );
+				__m256i c1 = _mm256_load_si256( reinterpret_cast<__m256i const*>(hi) );
+				__m256i c2 = streamLo;
+				__m256i c3 = streamHi;
+
+				std::uint32_t key0 = std::uint32_t(aSeed), key1 = std::uint32_t(aSeed >> 32);
+				for( int round = 0; round < 10; ++round )
+				{
+					__m256i hi0, lo0, hi1, lo1;
+					mulhilo( c0, mul0, hi0, lo0 );
+					mulhilo( c2, mul1, hi1, lo1 );
+
+					c0 = _mm256_xor_si256( _mm256_xor_si256( hi1, c1 ), _mm256_set1_epi32( int(key0) ) );
+					c1 = lo1;
+					c2 = _mm256_xor_si256( _mm256_xor_si256( hi0, c3 ), _mm256_set1_epi32( int(key1) ) );
+					c3 = lo0;
+
+					key0 += Philox4x32::kWeyl0;
+					key1 += Philox4x32::kWeyl1;
+				}
+
+				// Transpose; t0 = blocks 0|4, t1 = 1|5, t2 = 2|6, t3 = 3|7
+				__m256i const a0 = _mm256_unpacklo_epi32( c0, c1 );
+				__m256i const a1 = _mm256_unpacklo_epi32( c2, c3 );
+				__m256i const a2 = _mm256_unpackhi_epi32( c0, c1 );
+				__m256i const a3 = _mm256_unpackhi_epi32( c2, c3 );
+
+				__m256i const t0 = _mm256_unpacklo_epi64( a0, a1 );
+				__m256i const t1 = _mm256_unpackhi_epi64( a0, a1 );
+				__m256i const t2 = _mm256_unpacklo_epi64( a2, a3 );
+				__m256i const t3 = _mm256_unpackhi_epi64( a2, a3 );
+
+				__m256i* const out = reinterpret_cast<__m256i*>(aOut + 4*i);
+				_mm256_storeu_si256( out+0, _mm256_permute2x128_si256( t0, t1, 0x20 ) );
+				_mm256_storeu_si256( out+1, _mm256_permute2x128_si256( t2, t3, 0x20 ) );
+				_mm256_storeu_si256( out+2, _mm256_permute2x128_si256( t0, t1, 0x31 ) );
+				_mm256_storeu_si256( out+3, _mm256_permute2x128_si256( t2, t3, 0x31 ) );
+			}
+		}
+#		endif // ~ AVX2
+
+#		if defined(MAIN_PHILOX_SSE2)
+		{
+			__m128i const mul0 = _mm_set1_epi32( int(Philox4x32::kMul0) );
+			__m128i const mul1 = _mm_set1_epi32( int(Philox4x32::kMul1) );
+			__m128i const streamLo = _mm_set1_epi32( int(std::uint32_t(aStream)) );
+			__m128i const streamHi = _mm_set1_epi32( int(std::uint32_t(aStream >> 32)) );
+
+			auto const mulhilo = [] (__m128i aA, __m128i aMul, __m128i& aHi, __m128i& aLo) {
+				__m128i const even = _mm_mul_epu32( aA, aMul );
+				__m128i const odd = _mm_mul_epu32( _mm_srli_epi64( aA, 32 ), aMul );
+				aLo = _mm_unpacklo_epi32(
+					_mm_shuffle_epi32( even, _MM_SHUFFLE(3,1,2,0) ),
+					_mm_shuffle_epi32( odd, _MM_SHUFFLE(3,1,2,0) )
+				);
+				aHi = _mm_unpacklo_epi32(
+					_mm_shuffle_epi32( even, _MM_SHUFFLE(2,0,3,1) ),
+					_mm_shuffle_epi32( odd, _MM_SHUFFLE(2,0,3,1) )
+				);
+			};
+
+			for( ; i+4 <= aBlockCount; i += 4 )
+			{
+				std::uint32_t lo[4], hi[4];
+				for( int lane = 0; lane < 4; ++lane )
+				{
+					std::uint64_t const block = aFirstBlock + i + lane;
+					lo[lane] = std::uint32_t(block);
+					hi[lane] = std::uint32_t(block >> 32);
+				}
+
+				__m128i c0 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(lo) );
+				__m128i c1 = _mm_loadu_si128( reinterpret_cast<__m128i const*>(hi) );
+				__m128i c2 = streamLo;
+				__m128i c3 = streamHi;
+
+				std::uint32_t key0 = std::uint32_t(aSeed), key1 = std::uint32_t(aSeed >> 32);
+				for( int round = 0; round < 10; ++round )
+				{
+					__m128i hi0, lo0, hi1, lo1;
+					mulhilo( c0, mul0, hi0, lo0 );
+					mulhilo( c2, mul1, hi1, lo1 );
+
+					c0 = _mm_xor_si128( _mm_xor_si128( hi1, c1 ), _mm_set1_epi32( int(key0) ) );
+					c1 = lo1;
+					c2 = _mm_xor_si128( _mm_xor_si128( hi0, c3 ), _mm_set1_epi32( int(key1) ) );
+					c3 = lo0;
+
+					key0 += Philox4x32::kWeyl0;
+					key1 += Philox4x32::kWeyl1;
+				}
+
+				__m128i const a0 = _mm_unpacklo_epi32( c0, c1 );
+				__m128i const a1 = _mm_unpacklo_epi32( c2, c3 );
+				__m128i const a2 = _mm_unpackhi_epi32( c0, c1 );
+				__m128i const a3 = _mm_unpackhi_epi32( c2, c3 );
+
+				__m128i* const out = reinterpret_cast<__m128i*>(aOut + 4*i);
+				_mm_storeu_si128( out+0, _mm_unpacklo_epi64( a0, a1 ) );
+				_mm_storeu_si128( out+1, _mm_unpackhi_epi64( a0, a1 ) );
+				_mm_storeu_si128( out+2, _mm_unpacklo_epi64( a2, a3 ) );
+				_mm_storeu_si128( out+3, _mm_unpackhi_epi64( a2, a3 ) );
+			}
+		}
+#		endif // ~ SSE2
+
+		for( ; i < aBlockCount; ++i )
+			Philox4x32::generate_block( aSeed, aStream, aFirstBlock + i, aOut + 4*i );
+	}
+}
@@ -0,0 +1,143 @@
+#ifndef PHILOX_HPP_DFFA7786_C31C_4FEF_B6C1_038A4957E2F0
+#define PHILOX_HPP_DFFA7786_C31C_4FEF_B6C1_038A4957E2F0
+
+#include <cstdint>
+#include <cstdlib>
+
+/** Philox4x32-10 counter-based random number generator
+ *
+ * Philox (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3",
+ * SC'11) computes random numbers as a keyed bijection of a counter. Each
+ * 128-bit counter value yields a block of four 32-bit outputs, independent of
+ * any other block. There is no state besides the key and the counter.
+ *
+ * Here, the key is the 64-bit seed, and the counter is split into a 64-bit
+ * stream identifier and a 64-bit block index. Different streams with the same
+ * seed are therefore independent sequences (each 2^66 values long), and
+ * fork() derives new streams from a stream and an index. A subsystem that
+ * owns a forked stream gets the same sequence regardless of who else draws
+ * random numbers, or in which order.
+ *
+ * The class satisfies the UniformRandomBitGenerator requirements, so it can be
+ * used with the standard distributions.
+ */
+class Philox4x32 final
+{
+	public:
+		using result_type = std::uint32_t;
+
+	public:
+		explicit Philox4x32( std::uint64_t aSeed = 0, std::uint64_t aStream = 0 ) noexcept
+			: mSeed( aSeed )
+			, mStream( aStream )
+			, mBlock( 0 )
+			, mIndex( 4 )
+		{}
+
+	public:
+		static constexpr result_type min() noexcept { return 0; }
+		static constexpr result_type max() noexcept { return ~result_type(0); }
+
+		result_type operator()() noexcept
+		{
+			if( 4 == mIndex )
+			{
+				generate_block( mSeed, mStream, mBlock++, mBuffer );
+				mIndex = 0;
+			}
+
+			return mBuffer[mIndex++];
+		}
+
+		/* Derive an independent stream
+		 *
+		 * The new stream's identifier is a hash of this stream's identifier
+		 * and aIndex. It does not depend on how many numbers were drawn from
+		 * this stream.
+		 */
+		Philox4x32 fork( std::uint64_t aIndex ) const noexcept
+		{
+			// splitmix64 finalizer
+			std::uint64_t z = mStream + 0x9E3779B97F4A7C15ull * (aIndex + 1);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			z = z ^ (z >> 31);
+
+			return Philox4x32( mSeed, z );
+		}
+
+		/* Fill aOut with aCount uniformly distributed floats in [aMin, aMax)
+		 *
+		 * The values are the next aCount outputs of operator(), converted to
+		 * float; the stream's position advances accordingly. Blocks are
+		 * computed several at a time with SIMD instructions, so this is much
+		 * faster than drawing the numbers one by one.
+		 */
+		void fill_uniform( std::size_t aCount, float* aOut, float aMin = 0.f, float aMax = 1.f ) noexcept;
+
+		/* Fill aOut with aCount normally distributed floats
+		 *
+		 * Uses the Box-Muller transform, which turns two outputs of
+		 * operator() into two normally distributed values. (An odd count
+		 * still consumes an even number of outputs.)
+		 */
+		void fill_normal( std::size_t aCount, float* aOut, float aMean = 0.f, float aStddev = 1.f ) noexcept;
+
+		std::uint64_t seed() const noexcept { return mSeed; }
+		std::uint64_t stream() const noexcept { return mStream; }
+
+		/* Compute one block of output
+		 *
+		 * This is the whole generator: the output of operator() is the
+		 * concatenation of the blocks 0, 1, 2, ... of the stream.
+		 */
+		static void generate_block( std::uint64_t aSeed, std::uint64_t aStream, std::uint64_t aBlock, result_type aOut[4] ) noexcept
+		{
+			std::uint32_t ctr[4] = {
+				std::uint32_t(aBlock), std::uint32_t(aBlock >> 32),
+				std::uint32_t(aStream), std::uint32_t(aStream >> 32)
+			};
+			std::uint32_t key[2] = { std::uint32_t(aSeed), std::uint32_t(aSeed >> 32) };
+
+			for( int round = 0; round < 10; ++round )
+			{
+				std::uint64_t const p0 = std::uint64_t(kMul0) * ctr[0];
+				std::uint64_t const p1 = std::uint64_t(kMul1) * ctr[2];
+
+				std::uint32_t const next[4] = {
+					std::uint32_t(p1 >> 32) ^ ctr[1] ^ key[0],
+					std::uint32_t(p1),
+					std::uint32_t(p0 >> 32) ^ ctr[3] ^ key[1],
+					std::uint32_t(p0)
+				};
+
+				ctr[0] = next[0]; ctr[1] = next[1];
+				ctr[2] = next[2]; ctr[3] = next[3];
+
+				key[0] += kWeyl0;
+				key[1] += kWeyl1;
+			}
+
+			aOut[0] = ctr[0]; aOut[1] = ctr[1];
+			aOut[2] = ctr[2]; aOut[3] = ctr[3];
+		}
+
+	public:
+		static constexpr std::uint32_t kMul0 = 0xD2511F53u;
+		static constexpr std::uint32_t kMul1 = 0xCD9E8D57u;
+		static constexpr std::uint32_t kWeyl0 = 0x9E3779B9u;
+		static constexpr std::uint32_t kWeyl1 = 0xBB67AE85u;
+
+	private:
+		void fill_bits_( std::size_t, result_type* ) noexcept;
+
+	private:
+		std::uint64_t mSeed;
+		std::uint64_t mStream;
+		std::uint64_t mBlock; // Next block to generate
+
+		result_type mBuffer[4];
+		unsigned mIndex; // Next value in mBuffer (4 = empty)
+};
+
+#endif // PHILOX_HPP_DFFA7786_C31C_4FEF_B6C1_038A4957E2F0
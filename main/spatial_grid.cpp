@@ -0,0 +1,125 @@
+#include "spatial_grid.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include <cassert>
+
+SpatialGrid::SpatialGrid( float aCellSize )
+	: mCellSize( aCellSize )
+	, mInvCellSize( 1.f / aCellSize )
+	, mOrigin{ 0.f, 0.f }
+	, mCellsX( 1 )
+	, mCellsY( 1 )
+	, mCellStart( 2, 0 )
+{
+	assert( aCellSize > 0.f );
+}
+
+
+void SpatialGrid::build( std::size_t aCount, float const* aX, float const* aY, Vec2f aMin, Vec2f aMax )
+{
+	assert( aX && aY );
+	assert( aMin.x <= aMax.x && aMin.y <= aMax.y );
+
+	mOrigin = aMin;
+	mCellsX = std::max( std::uint32_t(std::ceil( (aMax.x - aMin.x) * mInvCellSize )), std::uint32_t(1) );
+	mCellsY = std::max( std::uint32_t(std::ceil( (aMax.y - aMin.y) * mInvCellSize )), std::uint32_t(1) );
+
+	std::size_t const cellCount = std::size_t(mCellsX) * mCellsY;
+
+	// Counting sort: count the points per cell (shifted by one), turn the
+	// counts into start offsets, then scatter.
+	mCellOf.resize( aCount );
+	mCellStart.assign( cellCount+1, 0 );
+
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		auto const cell = cell_y_( aY[i] ) * mCellsX + cell_x_( aX[i] );
+		mCellOf[i] = cell;
+		++mCellStart[cell+1];
+	}
+
+	for( std::size_t c = 0; c < cellCount; ++c )
+		mCellStart[c+1] += mCellStart[c];
+
+	mEntries.resize( aCount );
+	mEntryX.resize( aCount );
+	mEntryY.resize( aCount );
+
+	// Use the start offsets as insertion cursors; afterwards, mCellStart[c]
+	// holds the end of cell c. Shift back by one to restore the starts.
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		auto const slot = mCellStart[mCellOf[i]]++;
+		mEntries[slot] = std::uint32_t(i);
+		mEntryX[slot] = aX[i];
+		mEntryY[slot] = aY[i];
+	}
+
+	for( std::size_t c = cellCount; c > 0; --c )
+		mCellStart[c] = mCellStart[c-1];
+	mCellStart[0] = 0;
+}
+
+void SpatialGrid::query_aabb( Vec2f aMin, Vec2f aMax, std::vector<std::uint32_t>& aOut ) const
+{
+	if( aMin.x > aMax.x || aMin.y > aMax.y )
+		return;
+
+	auto const cx0 = cell_x_( aMin.x ), cx1 = cell_x_( aMax.x );
+	auto const cy0 = cell_y_( aMin.y ), cy1 = cell_y_( aMax.y );
+
+	for( auto cy = cy0; cy <= cy1; ++cy )
+	{
+		// The cells of a row are adjacent, so the row's points are one
+		// contiguous range.
+		auto const begin = mCellStart[cy*mCellsX + cx0];
+		auto const end = mCellStart[cy*mCellsX + cx1 + 1];
+
+		for( auto j = begin; j < end; ++j )
+		{
+			float const x = mEntryX[j], y = mEntryY[j];
+			if( x >= aMin.x && x <= aMax.x && y >= aMin.y && y <= aMax.y )
+				aOut.emplace_back( mEntries[j] );
+		}
+	}
+}
+
+void SpatialGrid::query_radius( Vec2f aCenter, float aRadius, std::vector<std::uint32_t>& aOut ) const
+{
+	if( aRadius < 0.f )
+		return;
+
+	auto const cx0 = cell_x_( aCenter.x - aRadius ), cx1 = cell_x_( aCenter.x + aRadius );
+	auto const cy0 = cell_y_( aCenter.y - aRadius ), cy1 = cell_y_( aCenter.y + aRadius );
+
+	float const radiusSquared = aRadius * aRadius;
+
+	for( auto cy = cy0; cy <= cy1; ++cy )
+	{
+		auto const begin = mCellStart[cy*mCellsX + cx0];
+		auto const end = mCellStart[cy*mCellsX + cx1 + 1];
+
+		for( auto j = begin; j < end; ++j )
+		{
+			float const dx = mEntryX[j] - aCenter.x;
+			float const dy = mEntryY[j] - aCenter.y;
+			if( dx*dx + dy*dy <= radiusSquared )
+				aOut.emplace_back( mEntries[j] );
+		}
+	}
+}
+
+std::uint32_t SpatialGrid::cell_x_( float aX ) const noexcept
+{
+	// Clamp in float, before the conversion (which is undefined for values
+	// outside of the integer's range).
+	float const cell = std::clamp( (aX - mOrigin.x) * mInvCellSize, 0.f, float(mCellsX-1) );
+	return std::uint32_t(cell);
+}
+std::uint32_t SpatialGrid::cell_y_( float aY ) const noexcept
+{
+	float const cell = std::clamp( (aY - mOrigin.y) * mInvCellSize, 0.f, float(mCellsY-1) );
+	return std::uint32_t(cell);
+}
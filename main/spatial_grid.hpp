@@ -0,0 +1,66 @@
+#ifndef SPATIAL_GRID_HPP_8DA2709C_2490_4BC7_9D71_1E6811C58A56
+#define SPATIAL_GRID_HPP_8DA2709C_2490_4BC7_9D71_1E6811C58A56
+
+#include <vector>
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "../vmlib/vec2.hpp"
+
+/** Uniform grid over a set of points
+ *
+ * The grid is rebuilt from scratch with build(), in O(N): points are binned
+ * into square cells of a fixed size with a counting sort. Each cell's points
+ * are then stored contiguously (along with a copy of their positions), so
+ * queries only visit the cells that overlap the query region and read
+ * memory linearly within each cell.
+ *
+ * The grid covers the rectangle passed to build(). Points outside of it are
+ * put into the closest border cell, so queries still find them (at the cost
+ * of crowding those cells).
+ *
+ * Queries return the indices of the points (as passed to build()). The grid
+ * only knows about points; for objects with an extent, grow the query by the
+ * largest object radius, and test the candidates exactly.
+ */
+class SpatialGrid final
+{
+	public:
+		explicit SpatialGrid( float aCellSize );
+
+	public:
+		void build(
+			std::size_t aCount,
+			float const* aX, float const* aY,
+			Vec2f aMin, Vec2f aMax
+		);
+
+		/* Append all points in [aMin, aMax] (inclusive) to aOut */
+		void query_aabb( Vec2f aMin, Vec2f aMax, std::vector<std::uint32_t>& aOut ) const;
+
+		/* Append all points at most aRadius away from aCenter to aOut */
+		void query_radius( Vec2f aCenter, float aRadius, std::vector<std::uint32_t>& aOut ) const;
+
+		float cell_size() const noexcept { return mCellSize; }
+
+	private:
+		std::uint32_t cell_x_( float ) const noexcept;
+		std::uint32_t cell_y_( float ) const noexcept;
+
+	private:
+		float mCellSize, mInvCellSize;
+
+		Vec2f mOrigin;
+		std::uint32_t mCellsX, mCellsY;
+
+		// Points of cell c are mEntries[mCellStart[c]] to
+		// mEntries[mCellStart[c+1]-1], with positions in mEntryX/Y.
+		std::vector<std::uint32_t> mCellStart;
+		std::vector<std::uint32_t> mEntries;
+		std::vector<float> mEntryX, mEntryY;
+
+		std::vector<std::uint32_t> mCellOf; // Scratch for build()
+};
+
+#endif // SPATIAL_GRID_HPP_8DA2709C_2490_4BC7_9D71_1E6811C58A56
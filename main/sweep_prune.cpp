@@ -0,0 +1,112 @@
+#include "sweep_prune.hpp"
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+#include <cassert>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define MAIN_SWEEP_PRUNE_SSE2 1
+#	include <emmintrin.h>
+#endif
+
+void SweepAndPrune::find_pairs( std::size_t aCount, float const* aX, float const* aY, float const* aRadius, std::vector<Pair>& aPairs )
+{
+	assert( 0 == aCount || (aX && aY && aRadius) );
+
+	aPairs.clear();
+
+	// Start from scratch if circles were added or removed.
+	if( mOrder.size() != aCount )
+	{
+		mOrder.resize( aCount );
+		std::iota( mOrder.begin(), mOrder.end(), std::uint32_t(0) );
+		std::sort( mOrder.begin(), mOrder.end(), [&] (std::uint32_t aA, std::uint32_t aB) {
+			return aX[aA] - aRadius[aA] < aX[aB] - aRadius[aB];
+		} );
+	}
+
+	std::uint32_t* const order = mOrder.data();
+
+	mMinX.resize( aCount );
+	mY.resize( aCount );
+	mRadius.resize( aCount );
+
+	float* const minX = mMinX.data();
+	float* const sweepY = mY.data();
+	float* const sweepRadius = mRadius.data();
+
+	for( std::size_t i = 0; i < aCount; ++i )
+		minX[i] = aX[order[i]] - aRadius[order[i]];
+
+	// Insertion sort. Circles that moved far (e.g., respawned asteroids) may
+	// have to travel further.
+	for( std::size_t i = 1; i < aCount; ++i )
+	{
+		auto const idx = order[i];
+		float const key = minX[i];
+
+		std::size_t j = i;
+		for( ; j > 0 && minX[j-1] > key; --j )
+		{
+			order[j] = order[j-1];
+			minX[j] = minX[j-1];
+		}
+
+		order[j] = idx;
+		minX[j] = key;
+	}
+
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		sweepY[i] = aY[order[i]];
+		sweepRadius[i] = aRadius[order[i]];
+	}
+
+	// Sweep: the candidates for circle a are the following circles that
+	// start before a ends.
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		auto const a = order[i];
+		float const maxX = minX[i] + 2.f*sweepRadius[i];
+
+		std::size_t j = i+1;
+		bool done = false;
+
+#		if defined(MAIN_SWEEP_PRUNE_SSE2)
+		// Four candidates at a time. Since the candidates are sorted, the
+		// ones that start before maxX form a prefix.
+		__m128 const endX = _mm_set1_ps( maxX );
+		__m128 const centerY = _mm_set1_ps( sweepY[i] );
+		__m128 const radiusA = _mm_set1_ps( sweepRadius[i] );
+		__m128 const absMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7fffffff ) );
+
+		for( ; j+4 <= aCount; j += 4 )
+		{
+			__m128 const inX = _mm_cmple_ps( _mm_loadu_ps( minX+j ), endX );
+			__m128 const dy = _mm_and_ps( _mm_sub_ps( _mm_loadu_ps( sweepY+j ), centerY ), absMask );
+			__m128 const inY = _mm_cmplt_ps( dy, _mm_add_ps( radiusA, _mm_loadu_ps( sweepRadius+j ) ) );
+
+			int const hits = _mm_movemask_ps( _mm_and_ps( inX, inY ) );
+			for( int lane = 0; lane < 4; ++lane )
+			{
+				if( hits & (1 << lane) )
+					aPairs.emplace_back( Pair{ a, order[j+lane] } );
+			}
+
+			if( 0xF != _mm_movemask_ps( inX ) )
+			{
+				done = true;
+				break;
+			}
+		}
+#		endif // ~ SSE2
+
+		for( ; !done && j < aCount && minX[j] <= maxX; ++j )
+		{
+			if( std::abs( sweepY[j] - sweepY[i] ) < sweepRadius[i] + sweepRadius[j] )
+				aPairs.emplace_back( Pair{ a, order[j] } );
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef SWEEP_PRUNE_HPP_80FC2966_251D_4ECF_8CF1_8A0C2AC0C52C
+#define SWEEP_PRUNE_HPP_80FC2966_251D_4ECF_8CF1_8A0C2AC0C52C
+
+#include <vector>
+
+#include <cstdint>
+#include <cstdlib>
+
+/** Sweep and prune along the x axis
+ *
+ * Finds the pairs of circles whose bounding boxes overlap. The circles are
+ * sorted by the left end of their boxes; each circle is then only compared
+ * to the following ones that start before it ends. Candidates that do not
+ * overlap along y are rejected in the same pass.
+ *
+ * The sort order is kept between calls and updated with an insertion sort.
+ * For objects that move little between calls, the order is nearly sorted
+ * already, and the sort is close to linear. It is only rebuilt from scratch
+ * when the number of circles changes.
+ *
+ * The sweep reads copies of the positions and radii, gathered in sweep
+ * order, so that its inner loop reads memory linearly. With SSE2, four
+ * candidates are tested at a time.
+ */
+class SweepAndPrune final
+{
+	public:
+		struct Pair
+		{
+			std::uint32_t a, b; // a's box starts first (or at the same x)
+		};
+
+	public:
+		/* Replace the contents of aPairs with the pairs of circles whose
+		 * bounding boxes overlap. Boxes touching along x count as
+		 * overlapping; along y they do not.
+		 *
+		 * Pairs are reported in sweep order: by a's position in the order,
+		 * then by b's.
+		 */
+		void find_pairs(
+			std::size_t aCount,
+			float const* aX, float const* aY, float const* aRadius,
+			std::vector<Pair>& aPairs
+		);
+
+	private:
+		std::vector<std::uint32_t> mOrder;
+		std::vector<float> mMinX, mY, mRadius;
+};
+
+#endif // SWEEP_PRUNE_HPP_80FC2966_251D_4ECF_8CF1_8A0C2AC0C52C
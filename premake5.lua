@@ -242,6 +242,57 @@ project "blit-benchmark"
 	links "x-stb"
 	links "x-benchmark"
 
+project "blit-test"
+	local sources = { 
+		"blit-test/**.cpp",
+		"blit-test/**.hpp",
+		"blit-test/**.hxx",
+		"blit-test/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "blit-test"
+
+	files( sources )
+
+	links "vmlib"
+	links "draw2d"
+	links "support"
+
+	links "x-stb"
+	links "x-catch2"
+
+project "main-test"
+	local sources = { 
+		"main-test/**.cpp",
+		"main-test/**.hpp",
+		"main-test/**.hxx",
+		"main-test/**.inl",
+
+		-- Simulation code from main that is tested here
+		"main/asteroid.cpp",
+		"main/asteroid.hpp",
+		"main/asteroid_field.cpp",
+		"main/asteroid_field.hpp",
+		"main/defaults.hpp",
+		"main/philox.cpp",
+		"main/philox.hpp",
+		"main/spatial_grid.cpp",
+		"main/spatial_grid.hpp",
+		"main/sweep_prune.cpp",
+		"main/sweep_prune.hpp"
+	}
+
+	kind "ConsoleApp"
+	location "main-test"
+
+	files( sources )
+
+	links "vmlib"
+	links "draw2d"
+
+	links "x-catch2"
+
 project "lines-benchmark"
 	local sources = { 
 		"lines-benchmark/**.cpp",
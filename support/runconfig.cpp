@@ -45,7 +45,7 @@ RuntimeConfig parse_command_line( int aArgc, char const* const* aArgv )
 				{
 					throw Error( "Error while parsing command line\n" 
 						"Value '%s' not valid for --fbshift; expected unsigned integer\n"
-						"Use --help to print available command line options", name );
+						"Use --help to print available command line options", value );
 				}
 
 				config.framebufferScaleShift = shift;
@@ -57,12 +57,25 @@ RuntimeConfig parse_command_line( int aArgc, char const* const* aArgv )
 				{
 					throw Error( "Error while parsing command line\n" 
 						"Value '%s' not valid for --geometry; expected <width>x<height>\n"
-						"Use --help to print available command line options", name );
+						"Use --help to print available command line options", value );
 				}
 
 				config.initialWindowWidth = width;
 				config.initialWindowHeight = height;
 			}
+			else if( 0 == std::strcmp( "seed", name ) )
+			{
+				unsigned seed = 0;
+				if( 1 != std::sscanf( value, "%u%c", &seed, &dummy ) )
+				{
+					throw Error( "Error while parsing command line\n" 
+						"Value '%s' not valid for --seed; expected unsigned integer\n"
+						"Use --help to print available command line options", value );
+				}
+
+				config.fixedSeed = true;
+				config.seed = seed;
+			}
 			else
 			{
 				throw Error( "Error while parsing command line\n" 
@@ -92,6 +105,7 @@ Where <flag> may be one off the following
 and where <option> and <value> may be the following
   geometry    <width>x<height>    set initial window size to (width, height)
   fbshift     <shift>             scale framebuffer by 2^-<shift> (unsigned int)
+  seed        <seed>              seed the random number generator (unsigned int)
 
 Example:
   %s --geometry=1920x1080 --fbshift=1
@@ -13,6 +13,11 @@ struct RuntimeConfig
 	unsigned initialWindowHeight = cfg::kInitialWindowHeight;
 
 	unsigned framebufferScaleShift = 0;
+
+	// Seed for the random number generator. Without --seed, a random seed
+	// is used.
+	bool fixedSeed = false;
+	unsigned seed = 0;
 };
 
 RuntimeConfig parse_command_line( int aArgc, char const* const* aArgv );
@@ -0,0 +1,199 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+
+#include "helpers.hpp"
+
+#include "../draw2d/surface.hpp"
+#include "../draw2d/shape.hpp"
+#include "../draw2d/color.hpp"
+
+namespace
+{
+	TriangleFan make_square_fan_()
+	{
+		TriangleFan::PosAndCol const verts[] = {
+			{ {   0.f,   0.f }, { 0.5f, 0.5f, 0.5f } },
+			{ {  10.f, -10.f }, { 1.0f, 0.5f, 0.5f } },
+			{ {  10.f,  10.f }, { 0.5f, 1.0f, 0.5f } },
+			{ { -10.f,  10.f }, { 0.5f, 0.5f, 1.0f } },
+			{ { -10.f, -10.f }, { 1.0f, 1.0f, 0.5f } }
+		};
+
+		return TriangleFan( verts );
+	}
+
+	std::size_t count_drawn_( Surface const& aSurface )
+	{
+		std::size_t count = 0;
+
+		auto const* ptr = aSurface.get_surface_ptr();
+		auto const pixels = std::size_t(aSurface.get_width()) * aSurface.get_height();
+		for( std::size_t i = 0; i < pixels; ++i, ptr += 4 )
+		{
+			if( ptr[0] || ptr[1] || ptr[2] )
+				++count;
+		}
+
+		return count;
+	}
+
+	ColorU8_sRGB read_pixel_( Surface const& aSurface, int aX, int aY )
+	{
+		auto const* ptr = aSurface.get_surface_ptr() + aSurface.get_linear_index( Surface::Index(aX), Surface::Index(aY) );
+		return { ptr[0], ptr[1], ptr[2] };
+	}
+}
+
+TEST_CASE( "Shape culling", "[shape][cull]" )
+{
+	Surface surface( 64, 48 );
+	surface.clear();
+
+	auto const fan = make_square_fan_();
+	Mat22f const identity{ 1.f, 0.f, 0.f, 1.f };
+
+	SECTION( "bounding radius" )
+	{
+		REQUIRE( std::abs( fan.bounding_radius() - 14.1421356f ) < 1e-4f );
+	}
+
+	SECTION( "fully offscreen" )
+	{
+		fan.draw( surface, identity, { -30.f, 20.f } );
+		fan.draw( surface, identity, { 100.f, 20.f } );
+		fan.draw( surface, identity, { 30.f, -20.f } );
+		fan.draw( surface, identity, { 30.f, 70.f } );
+
+		auto const col = find_most_red_pixel( surface );
+		REQUIRE( 0 == int(col.r) );
+		REQUIRE( 0 == int(col.g) );
+		REQUIRE( 0 == int(col.b) );
+	}
+
+	SECTION( "center offscreen" )
+	{
+		// Center is outside, but the fan overlaps the surface: the square
+		// covers [-15,5) x [10,30) (see "watertight" below).
+		fan.draw( surface, identity, { -5.f, 20.f } );
+
+		REQUIRE( 100 == count_drawn_( surface ) );
+	}
+
+	SECTION( "scaled near corner" )
+	{
+		// Only reaches into the surface thanks to the scaling: the square
+		// covers [-55,5) x [-55,5).
+		Mat22f const scale{ 0.f, -3.f, 3.f, 0.f };
+		fan.draw( surface, scale, { -25.f, -25.f } );
+
+		REQUIRE( 25 == count_drawn_( surface ) );
+	}
+}
+
+TEST_CASE( "Triangle fan rasterization", "[shape]" )
+{
+	Surface surface( 64, 48 );
+	surface.clear();
+
+	Mat22f const identity{ 1.f, 0.f, 0.f, 1.f };
+
+	SECTION( "watertight" )
+	{
+		// Square made from four triangles, with a single color. With the
+		// top-left rule, the left and bottom edges are included, the right
+		// and top edges are not: exactly 20x20 pixels.
+		ColorF const color{ 0.5f, 0.25f, 0.125f };
+		TriangleFan::PosAndCol const verts[] = {
+			{ {   0.f,   0.f }, color },
+			{ {  10.f, -10.f }, color },
+			{ {  10.f,  10.f }, color },
+			{ { -10.f,  10.f }, color },
+			{ { -10.f, -10.f }, color }
+		};
+
+		TriangleFan( verts ).draw( surface, identity, { 32.f, 24.f } );
+
+		REQUIRE( 400 == count_drawn_( surface ) );
+
+		auto const expected = linear_to_srgb( color );
+		for( int y = 14; y < 34; ++y )
+		{
+			for( int x = 22; x < 42; ++x )
+			{
+				auto const col = read_pixel_( surface, x, y );
+				REQUIRE( int(expected.r) == int(col.r) );
+				REQUIRE( int(expected.g) == int(col.g) );
+				REQUIRE( int(expected.b) == int(col.b) );
+			}
+		}
+	}
+
+	SECTION( "vertex colors" )
+	{
+		// Pixels on vertices get exactly the vertex' color.
+		make_square_fan_().draw( surface, identity, { 32.f, 24.f } );
+
+		auto const center = read_pixel_( surface, 32, 24 );
+		auto const expectedCenter = linear_to_srgb( ColorF{ 0.5f, 0.5f, 0.5f } );
+		REQUIRE( int(expectedCenter.r) == int(center.r) );
+		REQUIRE( int(expectedCenter.b) == int(center.b) );
+
+		auto const corner = read_pixel_( surface, 22, 14 );
+		auto const expectedCorner = linear_to_srgb( ColorF{ 1.0f, 1.0f, 0.5f } );
+		REQUIRE( int(expectedCorner.r) == int(corner.r) );
+		REQUIRE( int(expectedCorner.b) == int(corner.b) );
+	}
+
+	SECTION( "tint" )
+	{
+		// Colors are multiplied by the tint, and clamped to 1.
+		ColorF const color{ 0.5f, 0.25f, 0.125f };
+		TriangleFan::PosAndCol const verts[] = {
+			{ {   0.f,   0.f }, color },
+			{ {  10.f, -10.f }, color },
+			{ {  10.f,  10.f }, color },
+			{ { -10.f,  10.f }, color },
+			{ { -10.f, -10.f }, color }
+		};
+
+		TriangleFan( verts ).draw( surface, identity, { 32.f, 24.f }, ColorF{ 0.5f, 2.f, 10.f } );
+
+		REQUIRE( 400 == count_drawn_( surface ) );
+
+		auto const expected = linear_to_srgb( ColorF{ 0.25f, 0.5f, 1.f } );
+		auto const col = read_pixel_( surface, 30, 20 );
+		REQUIRE( int(expected.r) == int(col.r) );
+		REQUIRE( int(expected.g) == int(col.g) );
+		REQUIRE( int(expected.b) == int(col.b) );
+	}
+
+	SECTION( "levels of detail" )
+	{
+		// Level that drops the last rim vertex, (-10,-10). What remains is
+		// half of the square.
+		auto fan = make_square_fan_();
+
+		TriangleFan::Lod const lod{ 0x7, 20.f };
+		fan.set_lods( 1, &lod );
+
+		REQUIRE( 1 == fan.lod_count() );
+		REQUIRE( 0x7 == fan.get_lod( 0 ).rimMask );
+
+		// Projected radius is ~14.1 pixels: the level is used.
+		fan.draw( surface, identity, { 32.f, 24.f } );
+
+		auto const drawn = count_drawn_( surface );
+		REQUIRE( drawn >= 190 );
+		REQUIRE( drawn <= 210 );
+
+		auto const dropped = read_pixel_( surface, 24, 16 );
+		REQUIRE( 0 == int(dropped.r) );
+
+		// Projected radius is ~28.3 pixels: the full fan is used.
+		surface.clear();
+		fan.draw( surface, Mat22f{ 2.f, 0.f, 0.f, 2.f }, { 32.f, 24.f } );
+
+		REQUIRE( 1600 == count_drawn_( surface ) );
+	}
+}
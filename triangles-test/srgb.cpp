@@ -1,5 +1,11 @@
 #include <catch2/catch_amalgamated.hpp>
 
+#include <vector>
+#include <algorithm>
+
+#include <cmath>
+#include <cstdlib>
+
 #include "helpers.hpp"
 
 #include "../draw2d/surface.hpp"
@@ -49,3 +55,137 @@ TEST_CASE( "sRGB conversion", "[interp][sRGB]" )
 		REQUIRE( 192 == int(col.b) );
 	}
 }
+
+TEST_CASE( "Batched sRGB conversion", "[sRGB]" )
+{
+#	if DRAW2D_CFG_SRGB_MODE != DRAW2D_CFG_SRGB_EXACT
+#		error "These tests require SRGB_MODE == SRGB_EXACT"
+#	endif
+
+	SECTION( "encode within one LSB" )
+	{
+		// Dense sweep over [0,1], plus an odd count to exercise the tail.
+		std::size_t const count = (1u << 20) + 7;
+
+		std::vector<float> values( count );
+		for( std::size_t i = 0; i < count; ++i )
+			values[i] = float(i) / float(count-1);
+
+		std::vector<std::uint8_t> codes( count );
+		linear_to_srgb( count, values.data(), codes.data() );
+
+		int worst = 0;
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			int const expected = linear_to_srgb( values[i] );
+			worst = std::max( worst, std::abs( expected - int(codes[i]) ) );
+		}
+
+		REQUIRE( worst <= 1 );
+		REQUIRE( 0 == int(codes.front()) );
+		REQUIRE( 255 == int(codes.back()) );
+	}
+
+	SECTION( "encode colors" )
+	{
+		std::vector<ColorF> colors;
+		for( int i = 0; i <= 100; ++i )
+		{
+			float const t = float(i) / 100.f;
+			colors.emplace_back( ColorF{ t, 1.f - t, 0.5f * t } );
+		}
+
+		std::vector<ColorU8_sRGB> codes( colors.size() );
+		linear_to_srgb( colors.size(), colors.data(), codes.data() );
+
+		for( std::size_t i = 0; i < colors.size(); ++i )
+		{
+			auto const expected = linear_to_srgb( colors[i] );
+			REQUIRE( std::abs( int(expected.r) - int(codes[i].r) ) <= 1 );
+			REQUIRE( std::abs( int(expected.g) - int(codes[i].g) ) <= 1 );
+			REQUIRE( std::abs( int(expected.b) - int(codes[i].b) ) <= 1 );
+		}
+	}
+
+	SECTION( "encode clamps" )
+	{
+		float const values[] = { -1.f, -0.f, 2.f, 1e9f };
+		std::uint8_t codes[4];
+		linear_to_srgb( 4, values, codes );
+
+		REQUIRE( 0 == int(codes[0]) );
+		REQUIRE( 0 == int(codes[1]) );
+		REQUIRE( 255 == int(codes[2]) );
+		REQUIRE( 255 == int(codes[3]) );
+	}
+
+	SECTION( "decode exactly" )
+	{
+		std::uint8_t codes[256];
+		for( int i = 0; i < 256; ++i )
+			codes[i] = std::uint8_t(i);
+
+		float values[256];
+		linear_from_srgb( 256, codes, values );
+
+		for( int i = 0; i < 256; ++i )
+			REQUIRE( linear_from_srgb( std::uint8_t(i) ) == values[i] );
+
+		ColorU8_sRGB const colors[2] = { { 0, 128, 255 }, { 17, 34, 51 } };
+		ColorF decoded[2];
+		linear_from_srgb( 2, colors, decoded );
+
+		for( int i = 0; i < 2; ++i )
+		{
+			auto const expected = linear_from_srgb( colors[i] );
+			REQUIRE( expected.r == decoded[i].r );
+			REQUIRE( expected.g == decoded[i].g );
+			REQUIRE( expected.b == decoded[i].b );
+		}
+	}
+}
+
+TEST_CASE( "sRGB lookup tables", "[sRGB]" )
+{
+#	if DRAW2D_CFG_SRGB_MODE != DRAW2D_CFG_SRGB_EXACT
+#		error "These tests require SRGB_MODE == SRGB_EXACT"
+#	endif
+
+	SECTION( "encode within one LSB" )
+	{
+		std::size_t const count = (1u << 20) + 1;
+
+		int worst = 0;
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			float const value = float(i) / float(count-1);
+			int const expected = linear_to_srgb( value );
+			worst = std::max( worst, std::abs( expected - int(detail::linear_to_srgb_lut( value )) ) );
+		}
+
+		REQUIRE( worst <= 1 );
+		REQUIRE( 0 == int(detail::linear_to_srgb_lut( 0.f )) );
+		REQUIRE( 255 == int(detail::linear_to_srgb_lut( 1.f )) );
+	}
+
+	SECTION( "encode clamps" )
+	{
+		REQUIRE( 0 == int(detail::linear_to_srgb_lut( -1.f )) );
+		REQUIRE( 0 == int(detail::linear_to_srgb_lut( std::nanf( "" ) )) );
+		REQUIRE( 255 == int(detail::linear_to_srgb_lut( 2.f )) );
+	}
+
+	SECTION( "decode" )
+	{
+		// The table holds the curve evaluated in double precision; EXACT
+		// uses std::pow() in float. They differ by a few ULPs at most.
+		for( int i = 0; i < 256; ++i )
+		{
+			float const expected = linear_from_srgb( std::uint8_t(i) );
+			float const actual = detail::linear_from_srgb_lut( std::uint8_t(i) );
+
+			INFO( "code " << i );
+			REQUIRE( std::abs( expected - actual ) <= 1e-6f * expected );
+		}
+	}
+}
@@ -60,6 +60,25 @@ Vec2f operator*( Mat22f const& aLeft, Vec2f const& aRight ) noexcept
 	return finalVector;
 }
 
+constexpr
+float determinant( Mat22f const& aMat ) noexcept
+{
+	return aMat._00 * aMat._11 - aMat._01 * aMat._10;
+}
+
+// Inverse of a 2x2 matrix. The matrix must not be singular (i.e., the
+// determinant must be non-zero); check with determinant() first if unsure.
+constexpr
+Mat22f inverse( Mat22f const& aMat ) noexcept
+{
+	float const invDet = 1.f / determinant( aMat );
+
+	return Mat22f{
+		 aMat._11 * invDet, -aMat._01 * invDet,
+		-aMat._10 * invDet,  aMat._00 * invDet
+	};
+}
+
 // Learning how to handle a 2d rotation matrix from:
 // https://en.wikipedia.org/wiki/Rotation_matrix
 inline
@@ -0,0 +1,56 @@
+#ifndef TRANSFORM_HPP_7B333FA5_9B17_42E4_B043_7612ED75342E
+#define TRANSFORM_HPP_7B333FA5_9B17_42E4_B043_7612ED75342E
+
+#include <cstddef>
+
+#include "vec2.hpp"
+#include "mat22.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#	define VMLIB_TRANSFORM_SSE 1
+#	include <xmmintrin.h>
+#endif
+
+/** Transform a batch of points
+ *
+ * Computes
+ *
+ *   aOut[i] = aMatrix * aIn[i] + aTranslation
+ *
+ * for i in [0, aCount). This is the same arithmetic as the scalar operators
+ * in mat22.hpp (results may differ in the last bit if the compiler contracts
+ * one or the other into fused multiply-adds), but processes two points per
+ * SSE instruction where available. aIn and aOut may be the same array
+ * (in-place transform), but must not otherwise overlap.
+ *
+ * (This takes a pointer and a count rather than a span, since std::span
+ * requires C++20.)
+ */
+inline
+void transform_points( std::size_t aCount, Vec2f const* aIn, Vec2f* aOut, Mat22f const& aMatrix, Vec2f aTranslation ) noexcept
+{
+	std::size_t i = 0;
+
+#	if defined(VMLIB_TRANSFORM_SSE)
+	// Two points per register: [x0 y0 x1 y1]. With the swapped vector
+	// [y0 x0 y1 x1], the product is
+	//   [m00 m11 m00 m11] * v + [m01 m10 m01 m10] * swapped
+	__m128 const diag = _mm_setr_ps( aMatrix._00, aMatrix._11, aMatrix._00, aMatrix._11 );
+	__m128 const anti = _mm_setr_ps( aMatrix._01, aMatrix._10, aMatrix._01, aMatrix._10 );
+	__m128 const transl = _mm_setr_ps( aTranslation.x, aTranslation.y, aTranslation.x, aTranslation.y );
+
+	for( ; i + 2 <= aCount; i += 2 )
+	{
+		__m128 const v = _mm_loadu_ps( &aIn[i].x );
+		__m128 const swapped = _mm_shuffle_ps( v, v, _MM_SHUFFLE(2,3,0,1) );
+
+		__m128 const r = _mm_add_ps( _mm_add_ps( _mm_mul_ps( diag, v ), _mm_mul_ps( anti, swapped ) ), transl );
+		_mm_storeu_ps( &aOut[i].x, r );
+	}
+#	endif // ~ SSE
+
+	for( ; i < aCount; ++i )
+		aOut[i] = aMatrix * aIn[i] + aTranslation;
+}
+
+#endif // TRANSFORM_HPP_7B333FA5_9B17_42E4_B043_7612ED75342E